@@ -0,0 +1,177 @@
+#pragma once
+
+#include "Types_Compiler.hpp"
+#include "ParseTable.hpp"
+#include "token.hpp"
+
+namespace IStudio::Compiler
+{
+    // Bump allocator owning every node of one parse. Objects must be trivially
+    // destructible: the whole arena is released at once, without running destructors.
+    class AstArena
+    {
+    public:
+        static constexpr std::size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+    private:
+        struct Block
+        {
+            std::unique_ptr<std::byte[]> data;
+            std::size_t size;
+        };
+
+        std::vector<Block> blocks;
+        std::size_t blockSize;
+        std::size_t activeBlock = 0;
+        std::byte *cursor = nullptr;
+        std::size_t remaining = 0;
+        std::size_t used = 0;
+
+        void *tryBump(std::size_t bytes, std::size_t alignment)
+        {
+            void *p = cursor;
+            std::size_t space = remaining;
+            if (!p || !std::align(alignment, bytes, p, space))
+                return nullptr;
+
+            cursor = static_cast<std::byte *>(p) + bytes;
+            remaining = space - bytes;
+            used += bytes;
+            return p;
+        }
+
+        void *allocateSlow(std::size_t bytes, std::size_t alignment)
+        {
+            // Reuse blocks kept by reset() before asking for a new one.
+            while (activeBlock + 1 < blocks.size())
+            {
+                ++activeBlock;
+                cursor = blocks[activeBlock].data.get();
+                remaining = blocks[activeBlock].size;
+                if (void *p = tryBump(bytes, alignment))
+                    return p;
+            }
+
+            std::size_t size = std::max(blockSize, bytes + alignment);
+            blocks.push_back({std::make_unique_for_overwrite<std::byte[]>(size), size});
+            activeBlock = blocks.size() - 1;
+            cursor = blocks.back().data.get();
+            remaining = size;
+            return tryBump(bytes, alignment);
+        }
+
+    public:
+        explicit AstArena(std::size_t blockSize = DEFAULT_BLOCK_SIZE) : blockSize(blockSize) {}
+
+        AstArena(const AstArena &) = delete;
+        AstArena &operator=(const AstArena &) = delete;
+
+        // The source is left empty: its cursor must not point into blocks it no longer owns.
+        AstArena(AstArena &&other) noexcept
+            : blocks(std::move(other.blocks)),
+              blockSize(other.blockSize),
+              activeBlock(std::exchange(other.activeBlock, 0)),
+              cursor(std::exchange(other.cursor, nullptr)),
+              remaining(std::exchange(other.remaining, 0)),
+              used(std::exchange(other.used, 0))
+        {
+            other.blocks.clear();
+        }
+
+        AstArena &operator=(AstArena &&other) noexcept
+        {
+            if (this != &other)
+            {
+                blocks = std::move(other.blocks);
+                other.blocks.clear();
+                blockSize = other.blockSize;
+                activeBlock = std::exchange(other.activeBlock, 0);
+                cursor = std::exchange(other.cursor, nullptr);
+                remaining = std::exchange(other.remaining, 0);
+                used = std::exchange(other.used, 0);
+            }
+            return *this;
+        }
+
+        void *allocate(std::size_t bytes, std::size_t alignment)
+        {
+            if (void *p = tryBump(bytes, alignment))
+                return p;
+            return allocateSlow(bytes, alignment);
+        }
+
+        template <typename T, typename... Args>
+        T *create(Args &&...args)
+        {
+            static_assert(std::is_trivially_destructible_v<T>, "arena objects are never destroyed");
+            return ::new (allocate(sizeof(T), alignof(T))) T{std::forward<Args>(args)...};
+        }
+
+        template <typename T>
+        std::span<T> allocateArray(std::size_t count)
+        {
+            static_assert(std::is_trivially_destructible_v<T>, "arena objects are never destroyed");
+            if (count == 0)
+                return {};
+            auto *first = static_cast<T *>(allocate(sizeof(T) * count, alignof(T)));
+            std::uninitialized_default_construct_n(first, count);
+            return {first, count};
+        }
+
+        // Drops every node but keeps the blocks for the next parse.
+        void reset() noexcept
+        {
+            activeBlock = 0;
+            used = 0;
+            cursor = blocks.empty() ? nullptr : blocks.front().data.get();
+            remaining = blocks.empty() ? 0 : blocks.front().size;
+        }
+
+        std::size_t bytesUsed() const noexcept { return used; }
+        std::size_t blockCount() const noexcept { return blocks.size(); }
+    };
+
+    // AST node living in an AstArena. Leaves are tokens; `token` is the index of the
+    // leaf's token, or of the first token covered by an inner node.
+    struct ArenaNode
+    {
+        static constexpr std::uint32_t NO_TOKEN = std::numeric_limits<std::uint32_t>::max();
+
+        ParseTable::SymbolId symbol;
+        std::uint32_t token;
+        std::uint32_t childCount;
+        ArenaNode *const *children;
+
+        bool isLeaf() const noexcept { return childCount == 0; }
+        std::span<ArenaNode *const> getChildren() const noexcept { return {children, childCount}; }
+    };
+
+    // ParseDriver builder allocating ArenaNodes; child links are raw pointers into the arena.
+    class ArenaBuilder
+    {
+    private:
+        AstArena &arena;
+        const ParseTable &table;
+
+    public:
+        using value_type = ArenaNode *;
+
+        ArenaBuilder(AstArena &arena, const ParseTable &table) : arena(arena), table(table) {}
+
+        value_type shift(const Token &token, std::size_t index)
+        {
+            auto id = table.getSymbolId(token.getTerminal());
+            return arena.create<ArenaNode>(id.value_or(0), std::uint32_t(index), 0u, nullptr);
+        }
+
+        value_type reduce(const ParseTable::RuleInfo &rule, std::span<value_type> children)
+        {
+            auto slice = arena.allocateArray<ArenaNode *>(children.size());
+            std::copy(children.begin(), children.end(), slice.begin());
+
+            auto first = children.empty() ? ArenaNode::NO_TOKEN : children.front()->token;
+            return arena.create<ArenaNode>(rule.left, first, std::uint32_t(slice.size()), slice.data());
+        }
+    };
+
+} // namespace IStudio::Compiler
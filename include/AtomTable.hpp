@@ -0,0 +1,109 @@
+#pragma once
+
+#include "Types_Compiler.hpp"
+#include "Exception.hpp"
+
+namespace IStudio::Compiler
+{
+    using Atom = std::uint32_t;
+    inline constexpr Atom NO_ATOM = std::numeric_limits<Atom>::max();
+
+    // Interned lexemes of one compilation: equal texts get the same 32-bit Atom, so later
+    // phases compare names as integers and each spelling is stored once. The table is
+    // split into shards by hash, each behind its own lock, so lexers on several threads
+    // can intern into it at once; the low bits of an atom name its shard. Texts stay at
+    // the same address for the table's lifetime.
+    class AtomTable
+    {
+    private:
+        static constexpr unsigned SHARD_BITS = 4;
+        static constexpr std::size_t SHARDS = std::size_t(1) << SHARD_BITS;
+        static constexpr std::size_t MAX_PER_SHARD = (std::size_t(1) << (32 - SHARD_BITS)) - 1;
+        static constexpr std::size_t BLOCK_SIZE = 16 * 1024;
+
+        struct Shard
+        {
+            mutable std::shared_mutex mutex;
+            std::unordered_map<std::string_view, Atom> atoms;
+            std::vector<std::string_view> texts; // by atom >> SHARD_BITS
+            std::vector<std::unique_ptr<char[]>> blocks;
+            std::size_t used = 0; // bytes taken in blocks.back()
+
+            std::string_view store(std::string_view text)
+            {
+                if (text.empty())
+                    return {};
+                if (blocks.empty() || used + text.length() > BLOCK_SIZE)
+                {
+                    // a lexeme longer than a block gets one of its own
+                    blocks.push_back(std::make_unique<char[]>(std::max(text.length(), BLOCK_SIZE)));
+                    used = 0;
+                }
+                char *copy = blocks.back().get() + used;
+                std::memcpy(copy, text.data(), text.length());
+                used += text.length();
+                return {copy, text.length()};
+            }
+        };
+
+        std::array<Shard, SHARDS> shards;
+
+        static std::size_t shardOf(std::size_t hash) noexcept { return (hash >> 7) & (SHARDS - 1); }
+
+    public:
+        AtomTable() = default;
+        AtomTable(const AtomTable &) = delete;
+        AtomTable &operator=(const AtomTable &) = delete;
+
+        Atom intern(std::string_view text)
+        {
+            auto index = shardOf(std::hash<std::string_view>{}(text));
+            auto &shard = shards[index];
+            {
+                std::shared_lock lock{shard.mutex};
+                if (auto it = shard.atoms.find(text); it != shard.atoms.end())
+                    return it->second;
+            }
+
+            std::unique_lock lock{shard.mutex};
+            if (auto it = shard.atoms.find(text); it != shard.atoms.end())
+                return it->second; // interned by another thread meanwhile
+            if (shard.texts.size() >= MAX_PER_SHARD)
+                throw IStudio::Exception::RuntimeException{"Atom table is full"};
+
+            auto stored = shard.store(text);
+            auto atom = Atom(shard.texts.size() << SHARD_BITS | index);
+            shard.texts.push_back(stored);
+            shard.atoms.emplace(stored, atom);
+            return atom;
+        }
+
+        // Atom of `text` if it has been interned.
+        std::optional<Atom> find(std::string_view text) const
+        {
+            const auto &shard = shards[shardOf(std::hash<std::string_view>{}(text))];
+            std::shared_lock lock{shard.mutex};
+            auto it = shard.atoms.find(text);
+            return it == shard.atoms.end() ? std::nullopt : std::optional{it->second};
+        }
+
+        std::string_view text(Atom atom) const
+        {
+            const auto &shard = shards[atom & (SHARDS - 1)];
+            std::shared_lock lock{shard.mutex};
+            return shard.texts.at(atom >> SHARD_BITS);
+        }
+
+        std::size_t size() const
+        {
+            std::size_t total = 0;
+            for (const auto &shard : shards)
+            {
+                std::shared_lock lock{shard.mutex};
+                total += shard.texts.size();
+            }
+            return total;
+        }
+    };
+
+} // namespace IStudio::Compiler
@@ -6,6 +6,12 @@
 #include "Grammar.hpp"
 #include "Lexer.hpp"
 #include "Parser.hpp"
+#include "ParserSession.hpp"
+#include "IncrementalParser.hpp"
+#include "ContextParser.hpp"
+#include "SourceMap.hpp"
+#include "fs/File.hpp"
+#include "ThreadPool.hpp"
 #include "Logger.hpp"
 #include <fstream>
 
@@ -47,6 +53,16 @@ namespace IStudio::Compiler
         Parser parser;
         IStudio::Log::Logger logger;
 
+        // Gives the diagnostics of a failed run over `code` their lines and columns; the
+        // source is only mapped when there is something to report.
+        template <typename T>
+        static Error::Result<T> located(Error::Result<T> result, std::string_view code)
+        {
+            if (!result)
+                SourceMap{code}.locate(result.error());
+            return result;
+        }
+
     public:
         Compiler(const Grammar& grammar, IStudio::Log::Logger logger = Logger("logfile.txt", LogLevel::DEBUG, /*depth=*/0, /*defaultDepth=*/2))
             : lexer(grammar.getTerminals(), grammar.getSkipTerminals(), logger),
@@ -61,6 +77,145 @@ namespace IStudio::Compiler
             file << grammar;
         }
 
+        void setCollapseUnitChains(bool collapse) noexcept { parser.setCollapseUnitChains(collapse); }
+        void setSyncTerminals(const std::set<Terminal> &terminals) { parser.setSyncTerminals(terminals); }
+
+        // Interns identifiers and string literals into `atoms` for the compilations that
+        // follow; see Lexer::setAtomTable.
+        void setAtomTable(AtomTable *atoms) noexcept { lexer.setAtomTable(atoms); }
+
+        // Compiles without throwing on malformed input: lexical and syntax errors are all
+        // collected in one pass and returned instead of the tree.
+        Error::Result<std::shared_ptr<ASTNode>> check(const std::string &code) const
+        {
+            ASTBuilder builder;
+            Error::Diagnostics diagnostics;
+            return located(parser.tryParse(lexer.tokens(code, &diagnostics), builder, diagnostics), code);
+        }
+
+        const ArenaNode *compile(const std::string &code, AstArena &arena) const
+        {
+            return parser.parse(code | lexer, arena);
+        }
+
+        ParseTree::NodeId compile(const std::string &code, ParseTree &tree) const
+        {
+            return parser.parse(code | lexer, tree);
+        }
+
+        // GLR parse for grammars with conflicts; every derivation ends up in `forest`.
+        ParseForest::NodeId compile(const std::string &code, ParseForest &forest) const
+        {
+            return parser.parse(code | lexer, forest);
+        }
+
+        template <typename Value>
+        Value compile(const std::string &code, const SemanticActions<Value> &actions) const
+        {
+            return parser.parse(code | lexer, actions);
+        }
+
+        void compile(const std::string &code, ParseEventSink &sink) const
+        {
+            code | lexer | parser.events(sink);
+        }
+
+        // Pipeline stage for `code | compiler.events(sink)`: parses without building a tree.
+        struct EventStage
+        {
+            const Compiler &compiler;
+            ParseEventSink &sink;
+
+            friend void operator|(const std::string &code, const EventStage &stage)
+            {
+                stage.compiler.compile(code, stage.sink);
+            }
+        };
+
+        EventStage events(ParseEventSink &sink) const noexcept { return {*this, sink}; }
+
+        // Parses `inputs` in parallel on `pool`; const Compiler members are safe to share,
+        // since the tables are read-only and logging keeps no shared scratch state.
+        // fn(index, result) runs on the worker that parsed input `index`, with the tree in
+        // that worker's scratch arena, which is reset afterwards: fn must not keep the tree.
+        // Logging enabled per input (INFO and below) serializes the workers on the log file.
+        template <typename Fn>
+            requires std::invocable<Fn &, std::size_t, Error::Result<const ArenaNode *> &>
+        void compileBatch(std::span<const std::string_view> inputs, Fn &&fn,
+                          Util::ThreadPool &pool = Util::ThreadPool::shared()) const
+        {
+            std::vector<AstArena> arenas(pool.size());
+            pool.parallelFor(inputs.size(), [&](std::size_t index, std::size_t slot)
+                             {
+                                 auto &arena = arenas[slot];
+                                 ArenaBuilder builder{arena, parser.getTable()};
+                                 Error::Diagnostics diagnostics;
+                                 Error::Result<const ArenaNode *> result =
+                                     located(parser.tryParse(lexer.tokens(std::string{inputs[index]}, &diagnostics), builder, diagnostics), inputs[index]);
+                                 fn(index, result);
+                                 arena.reset();
+                             });
+        }
+
+        // Parallel compile keeping every result: a self-contained ParseTree per input, or
+        // its diagnostics.
+        std::vector<Error::Result<ParseTree>> compileBatch(std::span<const std::string_view> inputs,
+                                                           Util::ThreadPool &pool = Util::ThreadPool::shared()) const
+        {
+            std::vector<Error::Result<ParseTree>> results(inputs.size());
+            pool.parallelFor(inputs.size(), [&](std::size_t index, std::size_t)
+                             {
+                                 ParseTree tree;
+                                 ParseTreeBuilder builder{tree, parser.getTable()};
+                                 Error::Diagnostics diagnostics;
+                                 auto root = parser.tryParse(lexer.tokens(std::string{inputs[index]}, &diagnostics), builder, diagnostics);
+                                 if (root)
+                                     results[index] = std::move(tree);
+                                 else
+                                     results[index] = located(Error::Result<ParseTree>{std::unexpected(std::move(root.error()))}, inputs[index]);
+                             });
+            return results;
+        }
+
+        // One large input lexed by chunks and parsed by top-level declarations, both on `pool`.
+        std::shared_ptr<ASTNode> compileParallel(std::string_view code, Util::ThreadPool &pool = Util::ThreadPool::shared()) const
+        {
+            return parser.parseParallel(lexer.tokenizeParallel(code, pool), pool);
+        }
+
+        // Parses the file at `path` straight from its mapped contents.
+        std::shared_ptr<ASTNode> compileFile(const fs::path &path) const
+        {
+            File file{path};
+            return parser.parse(lexer.tokensIn(file.view()));
+        }
+
+        // Parses a stream of any length, such as std::cin, in constant memory.
+        std::shared_ptr<ASTNode> compileStream(std::istream &in) const
+        {
+            return parser.parse(lexer.tokens(in));
+        }
+
+        // Push-style parse for input that arrives in chunks.
+        ParserSession<> session() const
+        {
+            return ParserSession<>{lexer, parser};
+        }
+
+        // Document that reparses only what an edit damaged.
+        IncrementalParser incremental(Lang::String source) const
+        {
+            return IncrementalParser{lexer, parser, std::move(source)};
+        }
+
+        // Fused lexer and parser scanning only the terminals each parser state accepts.
+        ContextParser contextual() const
+        {
+            return ContextParser{lexer, parser};
+        }
+
+        const ParseTable &getTable() const noexcept { return parser.getTable(); }
+
         friend std::shared_ptr<ASTNode> operator|(const std::string code, Compiler &c)
         {
             return code | c.lexer | c.parser;
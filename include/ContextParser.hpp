@@ -0,0 +1,68 @@
+#pragma once
+
+#include "Types_Compiler.hpp"
+#include "Lexer.hpp"
+#include "Parser.hpp"
+#include "SourceMap.hpp"
+#include "Exception.hpp"
+
+namespace IStudio::Compiler
+{
+    // Lexer and parser run fused, the lexer trying at each position only the terminals
+    // the parser has an action for in its current state. This saves the regex attempts of
+    // terminals that cannot come next, and a word that is a keyword in one state can be a
+    // plain identifier in another.
+    class ContextParser
+    {
+    private:
+        const Lexer &lexer;
+        const Parser &parser;
+        std::vector<Lexer::ScanMask> masks; // per LR state
+
+    public:
+        ContextParser(const Lexer &lexer, const Parser &parser) : lexer(lexer), parser(parser)
+        {
+            const auto &table = parser.getTable();
+            masks.reserve(table.getStateCount());
+            for (ParseTable::StateId state = 0; state < table.getStateCount(); ++state)
+            {
+                masks.push_back(lexer.makeMask([&](const Terminal &terminal)
+                                               {
+                                                   auto id = table.getSymbolId(terminal);
+                                                   return id && table.isTerminal(*id) &&
+                                                          table.getAction(state, *id).kind != ParseTable::ActionKind::ERROR; }));
+            }
+        }
+
+        template <ParseBuilder Builder>
+        typename Builder::value_type parse(std::string_view input, Builder &builder) const
+        {
+            auto driver = parser.makeDriver(builder);
+            std::size_t position = 0;
+            while (position < input.length())
+            {
+                auto rest = input.substr(position);
+                auto match = lexer.scan(rest, masks[driver.currentState()]);
+                if (!match)
+                {
+                    auto at = SourceMap{input.substr(0, position + 1)}.locate(position);
+                    throw IStudio::Exception::UnexpectedInputException{
+                        std::format("🛑 Unexpected input at {}:{} → {}", at.line, at.column, rest.substr(0, 10))};
+                }
+
+                if (!match->skip)
+                    driver.feed(lexer.makeToken(*match, rest, position));
+                position += match->length;
+            }
+            driver.feed(Token{DOLLAR, "", input.length()});
+            return driver.finish();
+        }
+
+        std::shared_ptr<ASTNode> parse(std::string_view input) const
+        {
+            ASTBuilder builder;
+            return parse(input, builder);
+        }
+    };
+
+} // namespace IStudio::Compiler
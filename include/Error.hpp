@@ -1,13 +1,39 @@
 #ifndef ERROR_HPP_
 #define ERROR_HPP_
 
+#include "Types_Compiler.hpp"
+#include "Lang.hpp"
+
 namespace IStudio::Error
 {
-    
+    enum class Severity
+    {
+        ERROR,
+        WARNING
+    };
 
+    // A problem found in the input, reported as a value instead of an exception.
+    struct Diagnostic
+    {
+        Severity severity = Severity::ERROR;
+        std::string message;
+        std::size_t offset = 0;
+        Lang::Integer line = 0;
+        Lang::Integer column = 0;
 
+        friend std::ostream &operator<<(std::ostream &os, const Diagnostic &d)
+        {
+            os << d.line << ":" << d.column << ": " << (d.severity == Severity::ERROR ? "error" : "warning") << ": " << d.message;
+            return os;
+        }
+    };
 
-} // namespace IStudio::Error
+    using Diagnostics = std::vector<Diagnostic>;
 
+    // Value of a successful run, or every diagnostic collected on the way.
+    template <typename T>
+    using Result = std::expected<T, Diagnostics>;
+
+} // namespace IStudio::Error
 
-#endif // ERROR_HPP_
\ No newline at end of file
+#endif // ERROR_HPP_
@@ -0,0 +1,307 @@
+#pragma once
+
+#include "Types_Compiler.hpp"
+
+namespace IStudio::Compiler
+{
+    using ByteSet = std::bitset<256>;
+
+    // Bytes a non-empty match of an ECMAScript `pattern` can start with. Syntax the
+    // analysis does not follow (back-references, lookahead, \u escapes) gives every
+    // byte, so the set can be too large but never too small.
+    class FirstBytes
+    {
+    private:
+        struct Part
+        {
+            ByteSet first;
+            bool nullable = false;
+        };
+
+        std::string_view pattern;
+        std::size_t position = 0;
+        bool unknown = false;
+
+        bool atEnd() const { return position >= pattern.length(); }
+        char peek() const { return atEnd() ? '\0' : pattern[position]; }
+
+        static ByteSet single(unsigned char c)
+        {
+            ByteSet set;
+            set.set(c);
+            return set;
+        }
+
+        static ByteSet matching(int (*predicate)(int))
+        {
+            ByteSet set;
+            for (int c = 0; c < 128; ++c)
+            {
+                if (predicate(c))
+                    set.set(std::size_t(c));
+            }
+            return set;
+        }
+
+        static int isWord(int c) { return std::isalnum(c) || c == '_'; }
+
+        // Class escapes \d \w \s and their negations; nullopt for any other letter.
+        static std::optional<ByteSet> classEscape(char c)
+        {
+            switch (c)
+            {
+            case 'd': return matching([](int x) { return std::isdigit(x); });
+            case 'w': return matching(isWord);
+            case 's': return matching([](int x) { return std::isspace(x); });
+            case 'D': return ~matching([](int x) { return std::isdigit(x); });
+            case 'W': return ~matching(isWord);
+            case 'S': return ~matching([](int x) { return std::isspace(x); });
+            default: return std::nullopt;
+            }
+        }
+
+        static int hexValue(char c)
+        {
+            if (std::isdigit((unsigned char)c))
+                return c - '0';
+            if (c >= 'a' && c <= 'f')
+                return c - 'a' + 10;
+            if (c >= 'A' && c <= 'F')
+                return c - 'A' + 10;
+            return -1;
+        }
+
+        // Character named by the escape after a backslash, at `position`.
+        std::optional<unsigned char> characterEscape(bool inClass)
+        {
+            char c = pattern[position++];
+            switch (c)
+            {
+            case 'n': return '\n';
+            case 'r': return '\r';
+            case 't': return '\t';
+            case 'f': return '\f';
+            case 'v': return '\v';
+            case '0': return '\0';
+            case 'b':
+                if (inClass)
+                    return '\b';
+                break;
+            case 'c':
+                if (!atEnd() && std::isalpha((unsigned char)peek()))
+                    return (unsigned char)(pattern[position++] % 32);
+                break;
+            case 'x':
+                if (position + 1 < pattern.length() && hexValue(pattern[position]) >= 0 && hexValue(pattern[position + 1]) >= 0)
+                {
+                    auto value = hexValue(pattern[position]) * 16 + hexValue(pattern[position + 1]);
+                    position += 2;
+                    return (unsigned char)value;
+                }
+                break;
+            default:
+                if (!std::isalnum((unsigned char)c))
+                    return (unsigned char)c;
+                break;
+            }
+            unknown = true;
+            return std::nullopt;
+        }
+
+        ByteSet bracket()
+        {
+            ++position; // [
+            bool negated = peek() == '^';
+            if (negated)
+                ++position;
+            if (peek() == ']')
+            {
+                unknown = true; // [] and [^] are empty and universal in ECMAScript
+                return {};
+            }
+
+            ByteSet set;
+            while (!atEnd() && peek() != ']' && !unknown)
+            {
+                std::optional<unsigned char> low;
+                if (peek() == '\\' && position + 1 < pattern.length())
+                {
+                    ++position;
+                    if (auto escape = classEscape(peek()))
+                    {
+                        ++position;
+                        set |= *escape;
+                        continue;
+                    }
+                    low = characterEscape(true);
+                }
+                else
+                    low = (unsigned char)pattern[position++];
+                if (!low)
+                    break;
+
+                unsigned char high = *low;
+                if (peek() == '-' && position + 1 < pattern.length() && pattern[position + 1] != ']')
+                {
+                    ++position;
+                    if (peek() == '\\')
+                    {
+                        ++position;
+                        auto escaped = characterEscape(true);
+                        if (!escaped)
+                            break;
+                        high = *escaped;
+                    }
+                    else
+                        high = (unsigned char)pattern[position++];
+                }
+                for (unsigned c = *low; c <= high; ++c)
+                    set.set(c);
+            }
+            if (atEnd())
+                unknown = true;
+            ++position; // ]
+            return negated ? ~set : set;
+        }
+
+        Part atom()
+        {
+            char c = peek();
+            switch (c)
+            {
+            case '(':
+            {
+                ++position;
+                if (peek() == '?')
+                {
+                    if (position + 1 < pattern.length() && pattern[position + 1] == ':')
+                        position += 2;
+                    else
+                    {
+                        unknown = true; // lookahead
+                        return {};
+                    }
+                }
+                auto inner = alternation();
+                if (peek() != ')')
+                    unknown = true;
+                ++position;
+                return inner;
+            }
+            case '[':
+                return {bracket(), false};
+            case '.':
+            {
+                ByteSet set;
+                set.set();
+                set.reset('\n');
+                set.reset('\r');
+                ++position;
+                return {set, false};
+            }
+            case '^':
+            case '$':
+                ++position;
+                return {{}, true};
+            case '\\':
+            {
+                ++position;
+                if (atEnd())
+                {
+                    unknown = true;
+                    return {};
+                }
+                if (peek() == 'b' || peek() == 'B')
+                {
+                    ++position;
+                    return {{}, true};
+                }
+                if (auto escape = classEscape(peek()))
+                {
+                    ++position;
+                    return {*escape, false};
+                }
+                if (std::isdigit((unsigned char)peek()) && peek() != '0')
+                {
+                    unknown = true; // back-reference
+                    return {};
+                }
+                auto escaped = characterEscape(false);
+                return {escaped ? single(*escaped) : ByteSet{}, false};
+            }
+            default:
+                ++position;
+                return {single((unsigned char)c), false};
+            }
+        }
+
+        // Quantifiers allowing zero repetitions make the atom nullable.
+        void quantifier(Part &part)
+        {
+            char c = peek();
+            if (c == '*' || c == '?')
+            {
+                part.nullable = true;
+                ++position;
+            }
+            else if (c == '+')
+                ++position;
+            else if (c == '{')
+            {
+                auto close = pattern.find('}', position);
+                if (close == std::string_view::npos)
+                    return; // a literal brace
+                std::size_t minimum = 0;
+                auto [end, error] = std::from_chars(pattern.data() + position + 1, pattern.data() + close, minimum);
+                if (error != std::errc{})
+                    return;
+                part.nullable = part.nullable || minimum == 0;
+                position = close + 1;
+            }
+            else
+                return;
+            if (peek() == '?')
+                ++position; // lazy
+        }
+
+        Part sequence()
+        {
+            Part result{{}, true};
+            while (!atEnd() && peek() != '|' && peek() != ')' && !unknown)
+            {
+                auto part = atom();
+                quantifier(part);
+                if (result.nullable)
+                    result.first |= part.first;
+                result.nullable = result.nullable && part.nullable;
+            }
+            return result;
+        }
+
+        Part alternation()
+        {
+            auto result = sequence();
+            while (peek() == '|' && !unknown)
+            {
+                ++position;
+                auto branch = sequence();
+                result.first |= branch.first;
+                result.nullable = result.nullable || branch.nullable;
+            }
+            return result;
+        }
+
+        explicit FirstBytes(std::string_view pattern) : pattern{pattern} {}
+
+    public:
+        static ByteSet of(std::string_view pattern)
+        {
+            FirstBytes analysis{pattern};
+            auto result = analysis.alternation();
+            if (analysis.unknown || !analysis.atEnd())
+                return ByteSet{}.set();
+            return result.first;
+        }
+    };
+
+} // namespace IStudio::Compiler
@@ -0,0 +1,344 @@
+#pragma once
+
+#include "Types_Compiler.hpp"
+#include "ParseTable.hpp"
+#include "ParseForest.hpp"
+#include "token.hpp"
+#include "Exception.hpp"
+#include "Logger.hpp"
+
+namespace IStudio::Compiler
+{
+    // Generalized LR driver following every action of conflicted table cells. The LR
+    // stacks are merged into a graph-structured stack whose edges carry ParseForest
+    // nodes; derivations of the same symbol over the same tokens share one forest node.
+    // While there is a single stack top and the cell it reads is conflict free, actions
+    // are applied directly to the linear stack, so only ambiguous regions pay for the
+    // general machinery.
+    class GLRDriver
+    {
+    private:
+        using VertexId = std::uint32_t;
+        static constexpr std::uint32_t NO_EDGE = std::numeric_limits<std::uint32_t>::max();
+
+        struct Edge
+        {
+            VertexId target;
+            ParseForest::NodeId label;
+        };
+
+        struct Vertex
+        {
+            ParseTable::StateId state;
+            std::uint32_t level; // tokens shifted before the vertex was created
+            std::vector<Edge> edges;
+        };
+
+        // Reduction of `rule` along paths from `vertex` that begin with edge `edge` and, when
+        // `viaEdge` is set, go on through edge `viaEdge` of vertex `via`.
+        struct PendingReduce
+        {
+            VertexId vertex;
+            std::uint32_t edge;
+            ParseTable::RuleId rule;
+            VertexId via = 0;
+            std::uint32_t viaEdge = NO_EDGE;
+        };
+
+        struct LevelNode
+        {
+            ParseTable::SymbolId symbol;
+            std::uint32_t start;
+            ParseForest::NodeId node;
+        };
+
+        const ParseTable &table;
+        ParseForest &forest;
+        const IStudio::Log::Logger &logger;
+
+        std::vector<Vertex> vertices;
+        std::vector<VertexId> frontier; // stack tops, at most one per state
+        std::vector<PendingReduce> pending;
+        std::vector<LevelNode> levelNodes; // forest nodes ending at the current level
+        std::uint32_t level = 0;
+        std::optional<ParseForest::NodeId> root;
+        std::size_t generalSteps = 0;
+
+        [[noreturn]] void fail(const std::string &message) const
+        {
+            logger(IStudio::Log::LogLevel::ERROR, 1) << message;
+            throw IStudio::Exception::ParserException{message};
+        }
+
+        VertexId addVertex(ParseTable::StateId state)
+        {
+            vertices.push_back({state, level, {}});
+            return VertexId(vertices.size() - 1);
+        }
+
+        ParseForest::NodeId symbolNode(ParseTable::SymbolId symbol, std::uint32_t start)
+        {
+            for (const auto &entry : levelNodes)
+            {
+                if (entry.symbol == symbol && entry.start == start)
+                    return entry.node;
+            }
+            auto node = forest.addNode(symbol, start, level);
+            levelNodes.push_back({symbol, start, node});
+            return node;
+        }
+
+        VertexId *findTop(ParseTable::StateId state)
+        {
+            for (auto &vertex : frontier)
+            {
+                if (vertices[vertex].state == state)
+                    return &vertex;
+            }
+            return nullptr;
+        }
+
+        void enqueue(VertexId vertex, std::uint32_t edge, ParseTable::SymbolId lookahead,
+                     VertexId via = 0, std::uint32_t viaEdge = NO_EDGE)
+        {
+            for (const auto &action : table.getActions(vertices[vertex].state, lookahead))
+            {
+                if (action.kind != ParseTable::ActionKind::REDUCE)
+                    continue;
+                // Empty rules reduce once per vertex, the others once per new edge.
+                if ((table.getRule(action.value).length == 0) == (edge == NO_EDGE))
+                    pending.push_back({vertex, edge, action.value, via, viaEdge});
+            }
+        }
+
+        // A new edge of `top`, a vertex of this level, also extends the paths of the tops
+        // stacked onto it by empty reductions since. Their reductions are run again on
+        // the paths through the new edge only: the others have been reduced already.
+        void enqueueThrough(VertexId top, std::uint32_t edge, ParseTable::SymbolId lookahead)
+        {
+            for (auto vertex : frontier)
+            {
+                if (vertex == top)
+                    continue;
+                for (std::uint32_t first = 0; first < vertices[vertex].edges.size(); ++first)
+                {
+                    if (vertices[vertices[vertex].edges[first].target].level == level)
+                        enqueue(vertex, first, lookahead, top, edge);
+                }
+            }
+        }
+
+        // Deterministic step on a linear stack: fails over to the general algorithm when
+        // the path to reduce along forks.
+        bool reduceLinear(VertexId top, const ParseTable::RuleInfo &rule)
+        {
+            std::vector<ParseForest::NodeId> children(rule.length);
+            VertexId vertex = top;
+            for (auto i = rule.length; i > 0; --i)
+            {
+                if (vertices[vertex].edges.size() != 1)
+                    return false;
+                children[i - 1] = vertices[vertex].edges.front().label;
+                vertex = vertices[vertex].edges.front().target;
+            }
+
+            auto next = table.getGoto(vertices[vertex].state, rule.left);
+            if (next == ParseTable::NO_STATE)
+                fail("No valid state transition after reduce.");
+
+            auto node = symbolNode(rule.left, vertices[vertex].level);
+            forest.addFamily(node, rule.id, std::move(children));
+
+            auto created = addVertex(next);
+            vertices[created].edges.push_back({vertex, node});
+            frontier.assign(1, created);
+            return true;
+        }
+
+        // Paths of `remaining` edges from `vertex`; with `via` set, only those that use edge
+        // `viaEdge` of vertex `via` unless `passed` says an earlier edge was that one.
+        void collectPaths(VertexId vertex, std::uint32_t remaining, std::vector<ParseForest::NodeId> &labels,
+                          std::vector<std::pair<VertexId, std::vector<ParseForest::NodeId>>> &paths,
+                          VertexId via, std::uint32_t viaEdge, bool passed) const
+        {
+            if (remaining == 0)
+            {
+                if (passed)
+                    paths.emplace_back(vertex, std::vector<ParseForest::NodeId>{labels.rbegin(), labels.rend()});
+                return;
+            }
+            for (std::uint32_t i = 0; i < vertices[vertex].edges.size(); ++i)
+            {
+                const auto &edge = vertices[vertex].edges[i];
+                labels.push_back(edge.label);
+                collectPaths(edge.target, remaining - 1, labels, paths, via, viaEdge, passed || (vertex == via && i == viaEdge));
+                labels.pop_back();
+            }
+        }
+
+        void reduceGeneral(ParseTable::SymbolId lookahead)
+        {
+            ++generalSteps;
+            pending.clear();
+            for (auto vertex : frontier)
+            {
+                enqueue(vertex, NO_EDGE, lookahead);
+                for (std::uint32_t edge = 0; edge < vertices[vertex].edges.size(); ++edge)
+                    enqueue(vertex, edge, lookahead);
+            }
+
+            std::vector<std::pair<VertexId, std::vector<ParseForest::NodeId>>> paths;
+            std::vector<ParseForest::NodeId> labels;
+            for (std::size_t i = 0; i < pending.size(); ++i)
+            {
+                auto [vertex, edge, ruleId, via, viaEdge] = pending[i];
+                const auto &rule = table.getRule(ruleId);
+
+                paths.clear();
+                if (edge == NO_EDGE)
+                    paths.emplace_back(vertex, std::vector<ParseForest::NodeId>{});
+                else
+                {
+                    const auto first = vertices[vertex].edges[edge];
+                    labels.assign(1, first.label);
+                    collectPaths(first.target, rule.length - 1, labels, paths, via, viaEdge, viaEdge == NO_EDGE);
+                }
+
+                for (auto &[base, children] : paths)
+                {
+                    auto next = table.getGoto(vertices[base].state, rule.left);
+                    if (next == ParseTable::NO_STATE)
+                        continue; // this stack dies
+
+                    auto node = symbolNode(rule.left, vertices[base].level);
+                    forest.addFamily(node, rule.id, std::move(children));
+
+                    if (auto *top = findTop(next))
+                    {
+                        auto &edges = vertices[*top].edges;
+                        if (std::any_of(edges.begin(), edges.end(), [&](const Edge &e) { return e.target == base; }))
+                            continue; // same symbol node, already packed above
+                        edges.push_back({base, node});
+                        auto added = std::uint32_t(edges.size() - 1);
+                        enqueue(*top, added, lookahead);
+                        enqueueThrough(*top, added, lookahead);
+                    }
+                    else
+                    {
+                        auto created = addVertex(next);
+                        vertices[created].edges.push_back({base, node});
+                        frontier.push_back(created);
+                        enqueue(created, NO_EDGE, lookahead);
+                        enqueue(created, 0, lookahead);
+                    }
+                }
+            }
+        }
+
+    public:
+        GLRDriver(const ParseTable &table, ParseForest &forest, const IStudio::Log::Logger &logger)
+            : table(table), forest(forest), logger(logger)
+        {
+            frontier.push_back(addVertex(table.getStartState()));
+        }
+
+        // Runs the reductions `token` triggers on every stack, then shifts it onto all
+        // stacks that accept it. Returns true once the input has been accepted.
+        bool feed(const Token &token)
+        {
+            if (root)
+                return true;
+
+            const Terminal &terminal = token.getTerminal();
+            auto id = table.getSymbolId(terminal);
+            if (!id || !table.isTerminal(*id))
+                fail("No valid action for terminal: " + std::string{terminal.getName()});
+
+            levelNodes.clear();
+
+            // Deterministic fast path.
+            bool general = false;
+            while (frontier.size() == 1)
+            {
+                const auto &action = table.getAction(vertices[frontier.front()].state, *id);
+                if (action.conflicted)
+                {
+                    general = true;
+                    break;
+                }
+                if (action.kind == ParseTable::ActionKind::REDUCE)
+                {
+                    if (!reduceLinear(frontier.front(), table.getRule(action.value)))
+                    {
+                        general = true;
+                        break;
+                    }
+                    continue;
+                }
+                if (action.kind == ParseTable::ActionKind::ERROR)
+                    fail("No valid action for terminal: " + std::string{terminal.getName()});
+                break;
+            }
+            if (general || frontier.size() > 1)
+                reduceGeneral(*id);
+
+            if (logger.shouldLog(IStudio::Log::LogLevel::DEBUG, 2))
+                logger(IStudio::Log::LogLevel::DEBUG, 2) << "GLR stacks at " << level << ": " << frontier.size();
+
+            std::vector<VertexId> shifted;
+            std::optional<ParseForest::NodeId> leaf;
+            for (auto vertex : frontier)
+            {
+                for (const auto &action : table.getActions(vertices[vertex].state, *id))
+                {
+                    if (action.kind == ParseTable::ActionKind::ACCEPT && !vertices[vertex].edges.empty())
+                    {
+                        logger(IStudio::Log::LogLevel::INFO, 1) << "ACCEPT";
+                        root = vertices[vertex].edges.front().label;
+                        return true;
+                    }
+                    if (action.kind != ParseTable::ActionKind::SHIFT)
+                        continue;
+
+                    if (!leaf)
+                        leaf = forest.addLeaf(*id, level);
+
+                    auto it = std::find_if(shifted.begin(), shifted.end(), [&](VertexId v)
+                                           { return vertices[v].state == action.value; });
+                    VertexId target;
+                    if (it != shifted.end())
+                        target = *it;
+                    else
+                    {
+                        vertices.push_back({action.value, level + 1, {}});
+                        target = VertexId(vertices.size() - 1);
+                        shifted.push_back(target);
+                    }
+                    vertices[target].edges.push_back({vertex, *leaf});
+                }
+            }
+
+            if (shifted.empty())
+                fail("No valid action for terminal: " + std::string{terminal.getName()});
+
+            frontier = std::move(shifted);
+            ++level;
+            return false;
+        }
+
+        bool accepted() const noexcept { return root.has_value(); }
+
+        // Root of the forest; fails if the parser never reached ACCEPT.
+        ParseForest::NodeId finish() const
+        {
+            if (!root)
+                fail("Input not fully parsed.");
+            return *root;
+        }
+
+        // Number of tokens for which the general algorithm had to run.
+        std::size_t getGeneralSteps() const noexcept { return generalSteps; }
+        std::size_t getVertexCount() const noexcept { return vertices.size(); }
+    };
+
+} // namespace IStudio::Compiler
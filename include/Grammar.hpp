@@ -24,6 +24,8 @@ namespace IStudio::Compiler
         NonTerminals_Type nonterminals;
         Rule firstRule;
         Rules_Type rules;
+        Terminals_Type topLevelSync;
+        std::vector<std::pair<Terminal, Terminal>> nestingPairs;
         Util::UUID guid;
         mutable Logger logger;
 
@@ -64,7 +66,8 @@ namespace IStudio::Compiler
         Grammar(const Grammar& other)
             : start{other.start}, terminals{other.terminals}, skipTerminals{other.skipTerminals},
               nonterminals{other.nonterminals}, firstRule{other.firstRule},
-              rules{other.rules}, guid{other.guid}, logger{other.logger}
+              rules{other.rules}, topLevelSync{other.topLevelSync}, nestingPairs{other.nestingPairs},
+              guid{other.guid}, logger{other.logger}
         {
             logger(LogLevel::DEBUG, 1) << "📋 Grammar copied.";
         }
@@ -77,6 +80,8 @@ namespace IStudio::Compiler
                 nonterminals = other.nonterminals;
                 firstRule = other.firstRule;
                 rules = other.rules;
+                topLevelSync = other.topLevelSync;
+                nestingPairs = other.nestingPairs;
                 guid = other.guid;
                 logger = other.logger;
                 logger(LogLevel::DEBUG, 1) << "📝 Grammar assigned.";
@@ -114,6 +119,25 @@ namespace IStudio::Compiler
             return rules;
         }
 
+        // Terminals that end an independent top-level declaration when they occur outside
+        // every (open, close) nesting pair, e.g. `semicolon` outside braces.
+        Grammar& setTopLevelSync(Terminals_Type sync, std::vector<std::pair<Terminal, Terminal>> nesting = {}) {
+            topLevelSync = std::move(sync);
+            nestingPairs = std::move(nesting);
+            logger(LogLevel::DEBUG, 1) << "Top-level sync terminals: " << topLevelSync.size();
+            return *this;
+        }
+
+        const Terminals_Type& getTopLevelSync() const {
+            logger(LogLevel::TRACE, 2) << "🔍 getTopLevelSync() called.";
+            return topLevelSync;
+        }
+
+        const std::vector<std::pair<Terminal, Terminal>>& getNestingPairs() const {
+            logger(LogLevel::TRACE, 2) << "🔍 getNestingPairs() called.";
+            return nestingPairs;
+        }
+
         auto getRulesForSymbol(const Symbol& s) const {
             logger(LogLevel::TRACE, 2) << "🔍 getRulesForSymbol(" << s << ") called.";
             return rules | std::views::filter([&](const auto& r) { return r.getLeft() == s; });
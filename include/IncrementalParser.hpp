@@ -0,0 +1,450 @@
+#pragma once
+
+#include "Types_Compiler.hpp"
+#include "Lexer.hpp"
+#include "Parser.hpp"
+#include "Exception.hpp"
+
+namespace IStudio::Compiler
+{
+    // Source, tokens and AST of one document, reparsed after each edit. Tokens are
+    // updated with Lexer::rescan(), from the first token whose lexing read the edited text,
+    // in a buffer gapped at the edit. Every node records the LR state below it, so the parse
+    // stack in front of the damage is read off the old tree, and an old subtree past the
+    // damage is shifted whole when it starts in the state it was parsed from (Wagner-Graham
+    // reuse). Once the stack past the damage holds the states the old parse had there, the
+    // rest of the old parse would repeat: the old tree is kept and only the path down to
+    // that point is copied around the new subtrees.
+    class IncrementalParser
+    {
+    public:
+        struct Stats
+        {
+            std::size_t relexedTokens = 0;
+            std::size_t parsedTokens = 0; // shifted one by one
+            std::size_t reusedNodes = 0;
+            std::size_t reusedTokens = 0; // covered by reused subtrees
+            std::size_t copiedNodes = 0;  // old ancestors copied around new subtrees
+        };
+
+    private:
+        using Driver = ParseDriver<ASTBuilder>;
+
+        // Tokens with a gap at the last edit: `before` in order, `after` last token first,
+        // so moving the gap moves only the tokens it passes. Offsets in `after` lag behind
+        // by `shift`, the length change of the edits made since they were stored there.
+        // `reachEnds[i]` is the furthest any of before[0..i] reached, see Token::getReach.
+        class TokenBuffer
+        {
+            std::vector<Token> before;
+            std::vector<Token> after;
+            std::vector<std::size_t> reachEnds;
+            std::ptrdiff_t shift = 0;
+
+            void pushBefore(Token token)
+            {
+                auto end = Token::reachEnd(token.getOffset(), token.getReach());
+                reachEnds.push_back(reachEnds.empty() ? end : std::max(reachEnds.back(), end));
+                before.push_back(std::move(token));
+            }
+
+            void popBefore()
+            {
+                before.pop_back();
+                reachEnds.pop_back();
+            }
+
+        public:
+            TokenBuffer() = default;
+            explicit TokenBuffer(std::vector<Token> tokens)
+            {
+                before.reserve(tokens.size());
+                reachEnds.reserve(tokens.size());
+                for (auto &token : tokens)
+                    pushBefore(std::move(token));
+            }
+
+            std::size_t size() const noexcept { return before.size() + after.size(); }
+            bool empty() const noexcept { return size() == 0; }
+
+            // Offsets of tokens past the gap are stale, see offset().
+            const Token &operator[](std::size_t i) const
+            {
+                return i < before.size() ? before[i] : after[after.size() - 1 - (i - before.size())];
+            }
+
+            std::size_t offset(std::size_t i) const
+            {
+                if (i < before.size())
+                    return before[i].getOffset();
+                return std::size_t(std::ptrdiff_t((*this)[i].getOffset()) + shift);
+            }
+
+            void moveGap(std::size_t position)
+            {
+                for (; before.size() > position; popBefore())
+                {
+                    before.back().moveBy(-shift);
+                    after.push_back(std::move(before.back()));
+                }
+                for (; before.size() < position; after.pop_back())
+                {
+                    after.back().moveBy(shift);
+                    pushBefore(std::move(after.back()));
+                }
+            }
+
+            // First token whose lexing read the byte at `position`, the one Lexer::rescan
+            // has to start from when the text there changes. Tokens from the one at or
+            // past `position` on read it themselves, so only those before need looking at.
+            std::size_t firstReaching(std::size_t position)
+            {
+                auto indices = std::views::iota(std::size_t{0}, size());
+                auto past = std::ranges::partition_point(indices, [&](std::size_t i) { return offset(i) < position; });
+                moveGap(std::size_t(past - indices.begin()));
+                auto reaching = std::ranges::partition_point(reachEnds, [&](std::size_t end) { return end <= position; });
+                return std::size_t(reaching - reachEnds.begin());
+            }
+
+            // Puts `fresh` in place of tokens [first, first + removed) and moves the later
+            // ones by `delta`.
+            void replace(std::size_t first, std::size_t removed, std::vector<Token> fresh, std::ptrdiff_t delta)
+            {
+                moveGap(first);
+                after.erase(after.end() - std::ptrdiff_t(removed), after.end());
+                for (auto &token : fresh)
+                    pushBefore(std::move(token));
+                shift += delta;
+            }
+
+            std::vector<Token> toVector() const
+            {
+                std::vector<Token> tokens{before};
+                tokens.reserve(size());
+                for (auto it = after.rbegin(); it != after.rend(); ++it)
+                {
+                    tokens.push_back(*it);
+                    tokens.back().moveBy(shift);
+                }
+                return tokens;
+            }
+        };
+
+        // Node on the path from the old root to the last old position looked up, with the
+        // child the path continues into and the old position that child starts at.
+        struct Frame
+        {
+            const std::shared_ptr<ASTNode> *node;
+            std::size_t start;
+            std::size_t child;
+            std::size_t childStart;
+        };
+
+        // Previous tree and how its token positions map onto the new ones: old tokens
+        // [damageBegin, damageEnd) were replaced by new ones ending at newDamageEnd.
+        // Old positions are looked up in increasing order, so `path` only moves forward
+        // through the old tree and a reparse visits each old node at most once. `left`
+        // counts the left siblings along the path, the old parse's stack height there.
+        struct Reuse
+        {
+            std::shared_ptr<ASTNode> root;
+            std::size_t damageBegin = 0;
+            std::size_t damageEnd = 0;
+            std::size_t newDamageEnd = 0;
+            std::vector<Frame> path;
+            std::size_t left = 0;
+        };
+
+        // Outermost old node starting at old position `old`, or nullptr.
+        static const std::shared_ptr<ASTNode> *seek(Reuse &reuse, std::size_t old)
+        {
+            auto &path = reuse.path;
+            if (path.empty() || old < path.back().start)
+            {
+                path.assign(1, Frame{&reuse.root, 0, 0, 0});
+                reuse.left = 0;
+            }
+            while (path.size() > 1 && old >= path.back().start + (*path.back().node)->tokenCount)
+            {
+                reuse.left -= path.back().child;
+                path.pop_back();
+            }
+
+            while (path.back().start != old)
+            {
+                auto &frame = path.back();
+                const auto &children = (*frame.node)->children;
+                for (; frame.child < children.size() && old >= frame.childStart + children[frame.child]->tokenCount; ++reuse.left)
+                    frame.childStart += children[frame.child++]->tokenCount;
+                if (frame.child == children.size())
+                    return nullptr;
+                Frame next{&children[frame.child], frame.childStart, 0, frame.childStart};
+                path.push_back(next);
+            }
+            return path.back().node;
+        }
+
+        // Parse stack of `tree` once the reductions token `position` triggers have run: the
+        // left siblings along the path down to its leaf, over the states recorded below them.
+        static Driver::Snapshot stackAt(const std::shared_ptr<ASTNode> &tree, std::size_t position)
+        {
+            Driver::Snapshot stack{{}, {}, position};
+            const ASTNode *node = tree.get();
+            std::size_t start = 0;
+            while (!node->children.empty())
+            {
+                const ASTNode *next = nullptr;
+                for (const auto &child : node->children)
+                {
+                    if (position < start + child->tokenCount)
+                    {
+                        next = child.get();
+                        break;
+                    }
+                    stack.states.push_back(child->state);
+                    stack.values.push_back(child);
+                    start += child->tokenCount;
+                }
+                if (!next)
+                    throw IStudio::Exception::InternalCompilerError{"Token position outside the incremental tree."};
+                node = next;
+            }
+            stack.states.push_back(node->state);
+            return stack;
+        }
+
+        // Whether the driver's stack holds the states the old parse had at the start of the
+        // node `seek` last returned. Compared from the top down to a node before the damage
+        // that both stacks share: everything below it is the same left siblings.
+        static bool sameStack(const Reuse &reuse, const Driver &driver)
+        {
+            auto states = driver.states();
+            auto values = driver.values();
+            if (values.size() != reuse.left || states.back() != (*reuse.path.back().node)->state)
+                return false;
+
+            auto index = values.size();
+            for (auto f = reuse.path.size() - 1; f-- > 0;)
+            {
+                const auto &frame = reuse.path[f];
+                const auto &children = (*frame.node)->children;
+                auto end = frame.childStart;
+                for (auto c = frame.child; c-- > 0;)
+                {
+                    const auto &sibling = children[c];
+                    --index;
+                    if (values[index] == sibling && end <= reuse.damageBegin)
+                        return true;
+                    if (states[index] != sibling->state)
+                        return false;
+                    end -= sibling->tokenCount;
+                }
+            }
+            return true;
+        }
+
+        const Lexer &lexer;
+        const Parser &parser;
+        ASTBuilder builder;
+
+        Lang::String source;
+        TokenBuffer tokens; // ends with DOLLAR
+        std::shared_ptr<ASTNode> root;
+        Stats stats;
+        bool verify = false;
+
+        // The old tree with the driver's values in place of the old left siblings along the
+        // path sameStack() compared: every node on the path that changes is copied.
+        std::shared_ptr<ASTNode> graft(const Reuse &reuse, const Driver &driver)
+        {
+            auto values = driver.values();
+            auto index = values.size();
+            auto below = *reuse.path.back().node;
+            for (auto f = reuse.path.size() - 1; f-- > 0;)
+            {
+                const auto &frame = reuse.path[f];
+                const auto &node = *frame.node;
+                index -= frame.child;
+                auto siblings = values.subspan(index, frame.child);
+                if (below == node->children[frame.child] && std::ranges::equal(siblings, std::span{node->children}.first(frame.child)))
+                {
+                    below = node;
+                    continue;
+                }
+
+                auto copy = std::make_shared<ASTNode>(*node);
+                std::ranges::copy(siblings, copy->children.begin());
+                copy->children[frame.child] = std::move(below);
+                copy->tokenCount = 0;
+                for (const auto &child : copy->children)
+                    copy->tokenCount += child->tokenCount;
+                below = std::move(copy);
+                ++stats.copiedNodes;
+            }
+            return below;
+        }
+
+        void run(Driver &driver, std::size_t position, Reuse &reuse)
+        {
+            const auto &table = parser.getTable();
+            while (true)
+            {
+                const Token &token = tokens[position];
+                const auto &action = driver.reduceOn(token);
+
+                if (action.kind == ParseTable::ActionKind::SHIFT && reuse.root && position >= reuse.newDamageEnd)
+                {
+                    auto old = position - reuse.newDamageEnd + reuse.damageEnd;
+                    if (const auto *node = seek(reuse, old))
+                    {
+                        if (sameStack(reuse, driver))
+                        {
+                            root = graft(reuse, driver);
+                            return;
+                        }
+
+                        auto id = table.getSymbolId((*node)->symbol);
+                        std::size_t width = (*node)->tokenCount;
+                        if ((*node)->state == driver.currentState() && width > 0 && id && !table.isTerminal(*id))
+                        {
+                            driver.shiftNonterminal(*id, *node, width, tokens[position + width]);
+                            position += width;
+                            ++stats.reusedNodes;
+                            stats.reusedTokens += width;
+                            continue;
+                        }
+                    }
+                }
+
+                if (driver.feed(token) == Driver::Status::ACCEPTED)
+                    break;
+                ++position;
+                ++stats.parsedTokens;
+            }
+            root = driver.finish();
+        }
+
+        void reparse()
+        {
+            tokens = TokenBuffer{lexer.tokenizeWithReach(source)};
+            stats = {tokens.size() - 1, 0, 0, 0, 0};
+
+            auto driver = parser.makeDriver(builder);
+            Reuse none;
+            run(driver, 0, none);
+        }
+
+        void invalidate() noexcept
+        {
+            tokens = {};
+            root = nullptr;
+        }
+
+        static bool sameTree(const ASTNode *a, const ASTNode *b)
+        {
+            std::vector<std::pair<const ASTNode *, const ASTNode *>> pending{{a, b}};
+            while (!pending.empty())
+            {
+                auto [x, y] = pending.back();
+                pending.pop_back();
+                if (!x || !y)
+                {
+                    if (x != y)
+                        return false;
+                    continue;
+                }
+                if (x->symbol != y->symbol || x->tokenCount != y->tokenCount || x->atom != y->atom ||
+                    x->children.size() != y->children.size())
+                    return false;
+                for (std::size_t i = 0; i < x->children.size(); ++i)
+                    pending.emplace_back(x->children[i].get(), y->children[i].get());
+            }
+            return true;
+        }
+
+        // Lexes and parses the source from scratch and compares the results.
+        void check() const
+        {
+            auto expected = lexer.tokenize(source);
+            auto actual = tokens.toVector();
+            auto sameToken = [](const Token &a, const Token &b)
+            {
+                return a.getOffset() == b.getOffset() && a.getCode() == b.getCode() && a.getTerminal() == b.getTerminal();
+            };
+            if (!std::ranges::equal(expected, actual, sameToken))
+                throw IStudio::Exception::InternalCompilerError{"Incremental tokens differ from a full lex."};
+            if (!sameTree(parser.parse(expected).get(), root.get()))
+                throw IStudio::Exception::InternalCompilerError{"Incremental tree differs from a full parse."};
+        }
+
+    public:
+        IncrementalParser(const Lexer &lexer, const Parser &parser, Lang::String source)
+            : lexer(lexer), parser(parser), source(std::move(source))
+        {
+            reparse();
+        }
+
+        // Applies `edit` to the source and returns the new tree. If relexing or parsing
+        // fails the text keeps the edit, the exception propagates and the next edit
+        // starts from a full parse.
+        std::shared_ptr<ASTNode> edit(const TextEdit &edit)
+        {
+            if (edit.offset > source.length() || edit.removed > source.length() - edit.offset)
+                throw IStudio::Exception::RuntimeException{"Edit range is outside the source."};
+
+            try
+            {
+                source.replace(edit.offset, edit.removed, edit.inserted);
+                if (tokens.empty() || !root)
+                    reparse();
+                else
+                    update(edit);
+
+                if (verify)
+                    check();
+                return root;
+            }
+            catch (...)
+            {
+                invalidate();
+                throw;
+            }
+        }
+
+        // With verification on, each edit also lexes and parses the whole source again and
+        // throws InternalCompilerError unless the tokens and tree come out the same.
+        void setVerify(bool enabled) noexcept { verify = enabled; }
+
+        const std::shared_ptr<ASTNode> &getTree() const noexcept { return root; }
+        // Copies the token buffer.
+        std::vector<Token> getTokens() const { return tokens.toVector(); }
+        const Lang::String &getSource() const noexcept { return source; }
+        const Stats &getStats() const noexcept { return stats; }
+
+    private:
+        void update(const TextEdit &edit)
+        {
+            auto first = tokens.firstReaching(edit.offset);
+            auto [relexed, fresh] = lexer.rescan(source, edit, first, tokens.size(), [&](std::size_t i)
+                                                 { return Lexer::Extent{tokens.offset(i), tokens[i].getCode().length()}; });
+            auto delta = std::ptrdiff_t(edit.inserted.length()) - std::ptrdiff_t(edit.removed);
+            tokens.replace(relexed.first, relexed.removed, std::move(fresh), delta);
+
+            std::size_t damageBegin = relexed.first;
+            Reuse reuse{std::move(root), damageBegin, damageBegin + relexed.removed, damageBegin + relexed.inserted, {}, 0};
+            stats = {relexed.inserted, 0, 0, 0, 0};
+
+            // Resume on the token before the damage: the reductions it triggers do not
+            // depend on the damaged tokens.
+            auto driver = parser.makeDriver(builder);
+            std::size_t position = 0;
+            if (damageBegin > 0)
+            {
+                position = damageBegin - 1;
+                driver.restore(stackAt(reuse.root, position));
+            }
+            run(driver, position, reuse);
+        }
+    };
+
+} // namespace IStudio::Compiler
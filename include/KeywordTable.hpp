@@ -0,0 +1,163 @@
+#pragma once
+
+#include "Types_Compiler.hpp"
+#include "Terminal.hpp"
+
+namespace IStudio::Compiler
+{
+    // Perfect hash from keyword text to its KEYWORD terminal (hash and displace): the
+    // text is hashed once to pick a bucket, and each bucket has a displacement chosen at
+    // construction so that no two keywords share a slot. A lookup costs one hash, one
+    // slot and one string compare.
+    class KeywordTable
+    {
+    private:
+        struct Slot
+        {
+            std::string_view text;
+            Terminal terminal;
+            std::uint32_t index = 0; // position in the constructor argument
+            bool used = false;
+        };
+
+        std::vector<std::uint32_t> displacements; // per bucket
+        std::vector<Slot> slots;
+
+        static std::uint64_t hash(std::string_view text) noexcept
+        {
+            std::uint64_t h = 14695981039346656037ull;
+            for (unsigned char c : text)
+            {
+                h ^= c;
+                h *= 1099511628211ull;
+            }
+            return h;
+        }
+
+        static std::uint64_t mix(std::uint64_t h) noexcept
+        {
+            h ^= h >> 33;
+            h *= 0xff51afd7ed558ccdull;
+            h ^= h >> 33;
+            h *= 0xc4ceb9fe1a85ec53ull;
+            return h ^ (h >> 33);
+        }
+
+        std::size_t bucketOf(std::uint64_t h) const noexcept { return std::size_t(h >> 32) & (displacements.size() - 1); }
+
+        std::size_t slotOf(std::uint64_t h, std::uint32_t displacement) const noexcept
+        {
+            return std::size_t(mix(h + displacement * 0x9e3779b97f4a7c15ull)) & (slots.size() - 1);
+        }
+
+        // Places the largest buckets first; false if some bucket found no displacement.
+        bool place(const std::vector<std::tuple<std::string_view, Terminal, std::uint32_t>> &keywords)
+        {
+            std::vector<std::vector<std::size_t>> buckets(displacements.size());
+            for (std::size_t i = 0; i < keywords.size(); ++i)
+                buckets[bucketOf(hash(std::get<0>(keywords[i])))].push_back(i);
+
+            std::vector<std::size_t> order(buckets.size());
+            std::iota(order.begin(), order.end(), 0);
+            std::stable_sort(order.begin(), order.end(), [&](auto a, auto b) { return buckets[a].size() > buckets[b].size(); });
+
+            std::vector<std::size_t> taken;
+            for (auto bucket : order)
+            {
+                if (buckets[bucket].empty())
+                    break;
+
+                bool placed = false;
+                for (std::uint32_t displacement = 0; displacement < MAX_DISPLACEMENT && !placed; ++displacement)
+                {
+                    taken.clear();
+                    placed = true;
+                    for (auto i : buckets[bucket])
+                    {
+                        auto slot = slotOf(hash(std::get<0>(keywords[i])), displacement);
+                        if (slots[slot].used || std::find(taken.begin(), taken.end(), slot) != taken.end())
+                        {
+                            placed = false;
+                            break;
+                        }
+                        taken.push_back(slot);
+                    }
+                    if (placed)
+                    {
+                        displacements[bucket] = displacement;
+                        for (std::size_t k = 0; k < taken.size(); ++k)
+                        {
+                            const auto &[text, terminal, index] = keywords[buckets[bucket][k]];
+                            slots[taken[k]] = {text, terminal, index, true};
+                        }
+                    }
+                }
+                if (!placed)
+                    return false;
+            }
+            return true;
+        }
+
+        const Slot *lookup(std::string_view text) const noexcept
+        {
+            if (slots.empty())
+                return nullptr;
+            auto h = hash(text);
+            const auto &slot = slots[slotOf(h, displacements[bucketOf(h)])];
+            return slot.used && slot.text == text ? &slot : nullptr;
+        }
+
+    public:
+        static constexpr std::uint32_t MAX_DISPLACEMENT = 1u << 12;
+
+        KeywordTable() = default;
+
+        // Keywords with the same text keep the first one.
+        explicit KeywordTable(const std::vector<Terminal> &terminals)
+        {
+            std::vector<std::tuple<std::string_view, Terminal, std::uint32_t>> keywords;
+            for (std::uint32_t i = 0; i < terminals.size(); ++i)
+            {
+                auto text = terminals[i].getPattern();
+                if (std::none_of(keywords.begin(), keywords.end(), [&](const auto &k) { return std::get<0>(k) == text; }))
+                    keywords.emplace_back(text, terminals[i], i);
+            }
+            if (keywords.empty())
+                return;
+
+            displacements.assign(std::max<std::size_t>(std::bit_ceil(keywords.size()) / 4, 1), 0);
+            for (auto size = std::bit_ceil(keywords.size());; size *= 2)
+            {
+                slots.assign(size, Slot{});
+                if (place(keywords))
+                    return;
+            }
+        }
+
+        // Whether `terminal` is a keyword spelled by its pattern alone, without regex syntax.
+        static bool isLiteral(const Terminal &terminal)
+        {
+            auto pattern = terminal.getPattern();
+            return terminal.getTerminalType() == TerminalType::KEYWORD && !pattern.empty() &&
+                   std::all_of(pattern.begin(), pattern.end(), [](unsigned char c) { return std::isalnum(c) || c == '_'; });
+        }
+
+        // Keyword spelled `text`, or nullptr.
+        const Terminal *find(std::string_view text) const noexcept
+        {
+            const auto *slot = lookup(text);
+            return slot ? &slot->terminal : nullptr;
+        }
+
+        // Position of the keyword spelled `text` among the constructor's terminals.
+        std::optional<std::uint32_t> indexOf(std::string_view text) const noexcept
+        {
+            const auto *slot = lookup(text);
+            return slot ? std::optional{slot->index} : std::nullopt;
+        }
+
+        bool empty() const noexcept { return slots.empty(); }
+        std::size_t capacity() const noexcept { return slots.size(); }
+    };
+
+} // namespace IStudio::Compiler
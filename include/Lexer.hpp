@@ -6,28 +6,222 @@
 #include "Exception.hpp"
 #include "Lang.hpp"
 #include "Logger.hpp"
+#include "Util.hpp"
+#include "Error.hpp"
+#include "ThreadPool.hpp"
+#include "KeywordTable.hpp"
+#include "FirstBytes.hpp"
+#include "SkipScanner.hpp"
+#include "SourceMap.hpp"
+#include "AtomTable.hpp"
+#include "Literal.hpp"
+#include "ScannerGenerator.hpp"
 
 namespace IStudio::Compiler
 {
+    // Replacement of `removed` bytes at `offset` by `inserted`.
+    struct TextEdit
+    {
+        std::size_t offset = 0;
+        std::size_t removed = 0;
+        Lang::String inserted;
+    };
 
     class Lexer
     {
     public:
         using Terminals_Type = std::set<Terminal>;
 
+        // Terminals a scan may produce, indexed in getTerminals() order; see makeMask().
+        struct ScanMask
+        {
+            std::vector<bool> allowed;
+            bool anyKeyword = false;
+        };
+
+        struct Match
+        {
+            Terminal terminal;
+            std::size_t length = 0;
+            bool skip = false;
+        };
+
     private:
         Terminals_Type terminals;
         Terminals_Type skipSymbols;
+        Terminals_Type scanned;  // terminals matched by regex; the rest are in `keywords`
+        KeywordTable keywords;
+        std::vector<std::uint32_t> keywordIds; // per keyword, index in `terminals`
+        AtomTable *atoms = nullptr;            // see setAtomTable()
+        std::shared_ptr<LiteralArena> literals = std::make_shared<LiteralArena>(); // shared by copies
         mutable Logger logger;  // mutable to allow logging in const methods
 
+        // DFAs of the patterns, which tell how far a scan reads (see examined()). Built on
+        // first use and shared by copies; empty when a pattern is beyond ScannerGenerator.
+        struct Lookahead
+        {
+            std::once_flag built;
+            std::optional<ScannerGenerator> automata;
+        };
+        std::shared_ptr<Lookahead> lookahead = std::make_shared<Lookahead>();
+
+        // Terminals in scan order with their compiled patterns and, per first byte of the
+        // input, the indices of those that can match there (see FirstBytes).
+        struct Dispatch
+        {
+            std::vector<Terminal> terminals;
+            std::vector<std::regex> patterns;
+            std::vector<std::uint32_t> ids; // index in `all`, for ScanMask
+            std::array<std::vector<std::uint32_t>, 256> candidates;
+
+            Dispatch() = default;
+            Dispatch(const Terminals_Type &set, const Terminals_Type &all) : terminals{set.begin(), set.end()}
+            {
+                for (std::uint32_t i = 0; i < terminals.size(); ++i)
+                {
+                    ids.push_back(std::uint32_t(std::distance(all.begin(), all.find(terminals[i]))));
+                    patterns.emplace_back("^(" + std::string(terminals[i].getPattern()) + ")");
+                    auto first = FirstBytes::of(terminals[i].getPattern());
+                    for (std::size_t byte = 0; byte < candidates.size(); ++byte)
+                    {
+                        if (first.test(byte))
+                            candidates[byte].push_back(i);
+                    }
+                }
+            }
+
+            std::size_t averageCandidates() const
+            {
+                std::size_t total = 0;
+                for (const auto &list : candidates)
+                    total += list.size();
+                return total / candidates.size();
+            }
+        };
+
+        Dispatch scanDispatch;
+        Dispatch skipDispatch;
+        std::vector<SkipScanner> skipScanners; // per skipDispatch terminal
+        ByteSet directSkip;                    // every skip candidate has a SkipScanner
+        ByteSet skipOnly;                      // ... and no scanned terminal can start here
+
+        void buildSkipScanners()
+        {
+            skipScanners.clear();
+            for (const auto &terminal : skipDispatch.terminals)
+                skipScanners.emplace_back(terminal);
+            for (std::size_t byte = 0; byte < 256; ++byte)
+            {
+                const auto &candidates = skipDispatch.candidates[byte];
+                directSkip[byte] = !candidates.empty() && std::all_of(candidates.begin(), candidates.end(), [&](auto index)
+                                                                      { return skipScanners[index].getKind() != SkipScanner::Kind::NONE; });
+                skipOnly[byte] = directSkip[byte] && scanDispatch.candidates[byte].empty();
+            }
+        }
+
+        // Plain-word keywords that an identifier pattern also matches are not scanned on
+        // their own: an identifier lexeme is looked up in `keywords` instead, and an exact
+        // keyword always wins over the identifier.
+        void classifyKeywords()
+        {
+            std::vector<std::regex> identifiers;
+            for (const auto &terminal : terminals)
+            {
+                if (terminal.getTerminalType() == TerminalType::IDENTIFIER)
+                    identifiers.emplace_back(std::string(terminal.getPattern()));
+            }
+
+            std::vector<Terminal> words;
+            std::uint32_t id = 0;
+            for (const auto &terminal : terminals)
+            {
+                auto text = std::string(terminal.getPattern());
+                if (KeywordTable::isLiteral(terminal) &&
+                    std::any_of(identifiers.begin(), identifiers.end(), [&](const std::regex &re) { return std::regex_match(text, re); }))
+                {
+                    words.push_back(terminal);
+                    keywordIds.push_back(id);
+                }
+                else
+                    scanned.insert(terminal);
+                ++id;
+            }
+            keywords = KeywordTable{words};
+            logger(LogLevel::DEBUG, 1) << "Keywords looked up by hash: " << words.size() << " in " << keywords.capacity() << " slots";
+        }
+
     public:
         Lexer(Terminals_Type ts, Terminals_Type ss,
               Logger l = Logger("logfile.txt", LogLevel::DEBUG, 0, 2))
-            : terminals{std::move(ts)}, skipSymbols{std::move(ss)}, logger{std::move(l)} {}
+            : terminals{std::move(ts)}, skipSymbols{std::move(ss)}, logger{std::move(l)}
+        {
+            classifyKeywords();
+            scanDispatch = Dispatch{scanned, terminals};
+            skipDispatch = Dispatch{skipSymbols, skipSymbols};
+            buildSkipScanners();
+            logger(LogLevel::DEBUG, 1) << "Candidate terminals per first byte: " << scanDispatch.averageCandidates()
+                                       << " on average of " << scanned.size();
+        }
 
         auto getTerminals() const { return terminals; }
         auto getSkipSymbols() const { return skipSymbols; }
 
+        // Interns the lexemes of identifier and string literal tokens into `table`, which
+        // must outlive the lexing, and gives the tokens their Atom; nullptr turns interning
+        // off. Lexers on several threads may share one table.
+        void setAtomTable(AtomTable *table) noexcept { atoms = table; }
+        AtomTable *getAtomTable() const noexcept { return atoms; }
+
+        // Unescaped text of a string literal token this lexer or a copy of it made; valid
+        // while one of them lives. nullopt for other tokens.
+        std::optional<std::string_view> literalText(const Token &token) const
+        {
+            auto literal = std::get_if<StringLiteral>(&token.getValue());
+            if (!literal)
+                return std::nullopt;
+            return Literal::text(*literal, token.getCode(), *literals);
+        }
+
+        // Token for `match` at the start of `rest`, which is at `offset` in the source. A
+        // literal is decoded here, while its bytes are still in cache.
+        Token makeToken(const Match &match, std::string_view rest, std::size_t offset) const
+        {
+            auto lexeme = rest.substr(0, match.length);
+            const auto &terminal = match.terminal;
+            bool interned = atoms && (terminal.getTerminalType() == TerminalType::IDENTIFIER ||
+                                      terminal.getLiteralType() == LiteralType::STRING);
+            LiteralValue value;
+            if (terminal.getTerminalType() == TerminalType::LITERAL)
+                value = Literal::decode(terminal.getLiteralType(), lexeme, *literals);
+            return Token{terminal, Lang::String{lexeme}, offset, interned ? atoms->intern(lexeme) : NO_ATOM, std::move(value)};
+        }
+
+        // Mask of the terminals `accepts` lets a context-aware scan produce.
+        ScanMask makeMask(const std::function<bool(const Terminal &)> &accepts) const
+        {
+            ScanMask mask;
+            for (const auto &terminal : terminals)
+                mask.allowed.push_back(accepts(terminal));
+            mask.anyKeyword = std::any_of(keywordIds.begin(), keywordIds.end(), [&](auto id) { return mask.allowed[id]; });
+            return mask;
+        }
+
+        // Next lexeme at the start of `input`, trying only the terminals in `mask` before
+        // the skip terminals. An identifier lexeme spelling a keyword is that keyword where
+        // the mask allows it and an identifier where only the identifier is allowed. When
+        // nothing allowed or skippable matches, every terminal is tried, so the parser
+        // reports the unexpected token.
+        std::optional<Match> scan(std::string_view input, const ScanMask &mask) const
+        {
+            if (input.empty())
+                return std::nullopt;
+            if (auto [length, terminal] = scanMatch(input, &mask); length != 0)
+                return Match{std::move(terminal), length, false};
+            if (auto skipped = skipMatch(input))
+                return skipped;
+            return next(input);
+        }
+
         friend std::ostream &operator<<(std::ostream &o, const Lexer &l)
         {
             auto printSet = [](const auto &s, std::ostream &o1) -> std::ostream &
@@ -52,90 +246,619 @@ namespace IStudio::Compiler
             return o;
         }
 
-        std::vector<Token> tokenize(Lang::String input) const
+    private:
+        // Longest match at the start of `input` among the terminals of `dispatch` that can
+        // start with its first byte.
+        static std::pair<std::string_view, Terminal> longestMatch(const Dispatch &dispatch, std::string_view input)
         {
-            auto match = [](const Terminal &terminal, const Lang::String &input) -> Lang::String
+            std::string_view max;
+            Terminal max_terminal;
+            if (input.empty())
+                return {max, max_terminal};
+
+            for (auto index : dispatch.candidates[(unsigned char)input.front()])
             {
-                std::smatch sm;
-                std::regex re("^(" + std::string(terminal.getPattern()) + ")");
+                const auto &terminal = dispatch.terminals[index];
+                std::cmatch sm;
 
-                if (std::regex_search(input, sm, re))
+                // match_continuous: a failed match must not retry at every later offset.
+                if (std::regex_search(input.data(), input.data() + input.size(), sm, dispatch.patterns[index], std::regex_constants::match_continuous) &&
+                    std::size_t(sm.length(1)) > max.length())
                 {
-                    return sm[1].str();
+                    max = input.substr(0, sm.length(1));
+                    max_terminal = terminal;
+                }
+            }
+            return {max, max_terminal};
+        }
+
+        // Terminal the scanned terminal `index` yields for `lexeme` under `mask`, if any.
+        std::optional<Terminal> classify(std::uint32_t index, std::string_view lexeme, const ScanMask *mask) const
+        {
+            const auto &terminal = scanDispatch.terminals[index];
+            if (terminal.getTerminalType() == TerminalType::IDENTIFIER)
+            {
+                if (auto keyword = keywords.indexOf(lexeme); keyword && (!mask || mask->allowed[keywordIds[*keyword]]))
+                    return *keywords.find(lexeme);
+            }
+            if (!mask || mask->allowed[scanDispatch.ids[index]])
+                return terminal;
+            return std::nullopt;
+        }
+
+        // Longest scanned-terminal match at the start of `input`, keywords resolved.
+        std::pair<std::size_t, Terminal> scanMatch(std::string_view input, const ScanMask *mask) const
+        {
+            std::size_t longest = 0;
+            Terminal best;
+            for (auto index : scanDispatch.candidates[(unsigned char)input.front()])
+            {
+                if (mask && !mask->allowed[scanDispatch.ids[index]] &&
+                    !(mask->anyKeyword && scanDispatch.terminals[index].getTerminalType() == TerminalType::IDENTIFIER))
+                    continue;
+
+                std::cmatch sm;
+                if (!std::regex_search(input.data(), input.data() + input.size(), sm, scanDispatch.patterns[index], std::regex_constants::match_continuous) ||
+                    std::size_t(sm.length(1)) <= longest)
+                    continue;
+                if (auto terminal = classify(index, input.substr(0, sm.length(1)), mask))
+                {
+                    longest = sm.length(1);
+                    best = std::move(*terminal);
+                }
+            }
+            return {longest, best};
+        }
+
+        std::optional<Match> skipMatch(std::string_view input) const
+        {
+            if (directSkip.test((unsigned char)input.front()))
+                return skipRun(input);
+
+            auto [skipped, skip_terminal] = longestMatch(skipDispatch, input);
+            if (!skipped.empty())
+                return Match{skip_terminal, skipped.length(), true};
+            return std::nullopt;
+        }
+
+        // Whether a skip terminal matching at the start of `input` could match differently
+        // once more text follows it.
+        bool mayExtend(std::string_view input) const
+        {
+            if (input.empty() || !directSkip.test((unsigned char)input.front()))
+                return false;
+            const auto &candidates = skipDispatch.candidates[(unsigned char)input.front()];
+            return std::any_of(candidates.begin(), candidates.end(), [&](auto index) { return skipScanners[index].needsMore(input); });
+        }
+
+        // Bytes of `input` lexing its first lexeme reads, see ScannerGenerator::examined();
+        // the maximum if the patterns cannot be modelled.
+        std::size_t examined(std::string_view input) const
+        {
+            auto build = [&]
+            {
+                try
+                {
+                    lookahead->automata.emplace(terminals, skipSymbols);
+                }
+                catch (const IStudio::Exception::InvalidSyntaxException &e)
+                {
+                    logger(LogLevel::DEBUG, 1) << "No scan bounds, relexing restarts from the top: " << e.what();
                 }
-                return "";
             };
+            std::call_once(lookahead->built, build);
+            if (!lookahead->automata)
+                return std::numeric_limits<std::size_t>::max();
+            return lookahead->automata->examined(input);
+        }
 
-            std::vector<Token> result;
-            Lang::Integer column = 1, line = 1;
+        // Tokens of `source` from `position`, where a token's region starts, up to the end or
+        // to a region boundary where `synced` holds. A token's reach covers what lexing its
+        // region read: the skips before it and the token itself. DOLLAR's region holds the
+        // trailing skips, and it always reaches past the end.
+        template <typename Synced>
+        std::vector<Token> lexRegions(std::string_view source, std::size_t position, Synced &&synced) const
+        {
+            std::vector<Token> fresh;
+            std::size_t reachEnd = position;
+            bool boundary = true;
+            while (position < source.length())
+            {
+                if (boundary && synced(position))
+                    return fresh;
+
+                auto rest = source.substr(position);
+                auto match = next(rest);
+                if (!match)
+                    unexpectedInput(source, position);
+
+                auto read = examined(rest);
+                reachEnd = std::max(reachEnd, read > rest.length() + 1 ? std::numeric_limits<std::size_t>::max() : position + read);
+                boundary = !match->skip;
+                if (boundary)
+                {
+                    fresh.push_back(makeToken(*match, rest, position));
+                    fresh.back().setReach(reachEnd - position);
+                    reachEnd = position + match->length;
+                }
+                position += match->length;
+            }
+            if (boundary && synced(position))
+                return fresh;
+
+            fresh.emplace_back(DOLLAR, "", position);
+            fresh.back().setReach(std::max(reachEnd, position + 1) - position);
+            return fresh;
+        }
+
+        // Next lexeme at the start of `input`: the longest terminal match or, when no
+        // terminal matches, the longest skip-terminal match.
+        std::optional<Match> next(std::string_view input) const
+        {
+            if (input.empty())
+                return std::nullopt;
+            if (auto [length, terminal] = scanMatch(input, nullptr); length != 0)
+                return Match{std::move(terminal), length, false};
+            return skipMatch(input);
+        }
+
+        // Longest skip match at the start of `input` through the SkipScanners, in scan order.
+        std::pair<std::size_t, std::uint32_t> directSkipMatch(std::string_view input) const
+        {
+            std::size_t longest = 0;
+            std::uint32_t best = 0;
+            for (auto index : skipDispatch.candidates[(unsigned char)input.front()])
+            {
+                auto length = skipScanners[index].match(input);
+                if (length > longest)
+                {
+                    longest = length;
+                    best = index;
+                }
+            }
+            return {longest, best};
+        }
+
+        // Skip match without regex, extended over the skip lexemes that follow it as long as
+        // no scanned terminal can start there: skipping them one by one would give the same
+        // tokens.
+        std::optional<Match> skipRun(std::string_view input) const
+        {
+            auto [length, index] = directSkipMatch(input);
+            if (length == 0)
+                return std::nullopt;
+            while (length < input.length() && skipOnly.test((unsigned char)input[length]))
+            {
+                auto more = directSkipMatch(input.substr(length)).first;
+                if (more == 0)
+                    break;
+                length += more;
+            }
+            return Match{skipDispatch.terminals[index], length, true};
+        }
+
+        [[noreturn]] void unexpectedInput(SourceMap::Location at, std::string_view rest) const
+        {
+            Lang::String description = std::format("🛑 Unexpected input at {}:{} → {}", at.line, at.column, rest.substr(0, 10));
+            logger(LogLevel::ERROR, 1) << description;
+            throw IStudio::Exception::UnexpectedInputException{description};
+        }
+
+        // Unexpected input at `position` of `input`, which is only mapped on this error path.
+        [[noreturn]] void unexpectedInput(std::string_view input, std::size_t position) const
+        {
+            unexpectedInput(SourceMap{input.substr(0, position + 1)}.locate(position), input.substr(position));
+        }
+
+        // Lexemes found by scanning from a guessed boundary: every lexeme start, the number
+        // of tokens before it and the tokens themselves. `end` is where scanning stopped, the
+        // first boundary at or past the limit, or the offset where nothing matched.
+        struct Speculation
+        {
+            std::vector<std::size_t> boundaries;
+            std::vector<std::size_t> tokensBefore;
+            std::vector<Token> tokens;
+            std::size_t end = 0;
+        };
+
+        Speculation speculate(std::string_view input, std::size_t begin, std::size_t limit) const
+        {
+            Speculation result;
+            std::size_t position = begin;
+            while (position < limit && position < input.length())
+            {
+                auto rest = input.substr(position);
+                auto match = next(rest);
+                if (!match)
+                    break;
+
+                result.boundaries.push_back(position);
+                result.tokensBefore.push_back(result.tokens.size());
+                if (!match->skip)
+                    result.tokens.push_back(makeToken(*match, rest, position));
+                position += match->length;
+            }
+            result.end = position;
+            return result;
+        }
+
+    public:
+        // Lazily scans `input`, yielding one token at a time and DOLLAR at the end, so a
+        // consumer such as Parser::parse never needs the whole token vector in memory.
+        // With `diagnostics`, input that matches no terminal is reported there and skipped
+        // instead of throwing. Tokens carry their offset only; see SourceMap.
+        Util::generator<Token> tokens(Lang::String input, Error::Diagnostics *diagnostics = nullptr) const
+        {
+            for (const Token &token : tokensIn(input, diagnostics))
+                co_yield token;
+        }
+
+        // tokens() over text the caller keeps alive until the generator is done, such as
+        // a File::view(), so the input is not copied.
+        Util::generator<Token> tokensIn(std::string_view input, Error::Diagnostics *diagnostics = nullptr) const
+        {
+            std::string_view rest = input;
+            std::size_t count = 0;
+            std::optional<SourceMap> lines; // mapped at the first diagnostic
 
             logger(LogLevel::INFO, 1) << "🔍 Starting tokenization...";
 
-            while (!input.empty())
+            while (!rest.empty())
             {
-                Lang::String max = "";
-                Terminal max_terminal;
+                auto match = next(rest);
+                if (!match)
+                {
+                    auto position = input.length() - rest.length();
+                    if (!diagnostics)
+                        unexpectedInput(input, position);
 
-                // Match against defined terminals
-                for (const auto &terminal : terminals)
+                    // One diagnostic for the whole run of bytes that lexes as nothing.
+                    std::size_t length = 1;
+                    while (length < rest.length() && !next(rest.substr(length)))
+                        ++length;
+                    if (!lines)
+                        lines.emplace(input);
+                    auto [line, column] = lines->locate(position);
+                    diagnostics->push_back({Error::Severity::ERROR, "Unexpected input: " + std::string{rest.substr(0, std::min<std::size_t>(length, 10))},
+                                            position, line, column});
+                    rest.remove_prefix(length);
+                    continue;
+                }
+
+                auto lexeme = rest.substr(0, match->length);
+                if (match->skip)
                 {
-                    Lang::String temp = match(terminal, input);
-                    if (temp.length() > max.length())
-                    {
-                        max = temp;
-                        max_terminal = terminal;
-                    }
+                    if (logger.shouldLog(LogLevel::TRACE, 2))
+                        logger(LogLevel::TRACE, 2) << "Skipping: '" << lexeme << "'";
+                }
+                else
+                {
+                    if (logger.shouldLog(LogLevel::DEBUG, 2))
+                        logger(LogLevel::DEBUG, 2) << "Token: [" << match->terminal.getName() << "] = '" << lexeme << "'";
+                    co_yield makeToken(*match, rest, input.length() - rest.length());
+                    ++count;
+                }
+
+                // Advance
+                rest.remove_prefix(match->length);
+            }
+
+            logger(LogLevel::INFO, 1) << "✅ Tokenization complete. Total tokens: " << count;
+
+            // End of input marker
+            co_yield Token{DOLLAR, "", input.length()};
+        }
+
+        static constexpr std::size_t DEFAULT_STREAM_WINDOW = 64 * 1024;
+
+        // tokens() over a stream read through a window of `window` bytes, so memory stays
+        // constant whatever the input size (stdin, pipes, files larger than memory). The
+        // window is refilled between lexemes once less than half of it is left. A lexeme
+        // that may continue past the window, because it runs to the window's end or is a
+        // skipped comment whose end is not in sight, is rescanned after a refill; one
+        // longer than the whole window spills into a temporarily larger buffer. Text no
+        // terminal matches is only read on while some terminal still matches all of it, so
+        // it is reported without buffering the rest of the stream. Other lexemes are
+        // decided with at least half a window of lookahead.
+        Util::generator<Token> tokens(std::istream &in, std::size_t window = DEFAULT_STREAM_WINDOW) const
+        {
+            window = std::max<std::size_t>(window, 2);
+            std::string buffer(window, '\0');
+            std::size_t position = 0, end = 0;
+            std::size_t base = 0; // stream offset of buffer[0]
+            bool eof = false;
+            SourceMap lines; // of the text read so far, trimmed to the current line
+
+
+            // Moves the unread tail to the front and reads until the buffer is full.
+            auto refill = [&]
+            {
+                if (position > 0)
+                {
+                    lines.append({buffer.data(), position});
+                    lines.trim(base + position);
+                    std::memmove(buffer.data(), buffer.data() + position, end - position);
+                    base += position;
+                    end -= position;
+                    position = 0;
+                }
+                if (end == buffer.size())
+                    buffer.resize(buffer.size() * 2); // spill: one lexeme fills the window
+                else if (end < window && buffer.size() > window)
+                {
+                    buffer.resize(window);
+                    buffer.shrink_to_fit();
                 }
+                while (end < buffer.size() && !eof)
+                {
+                    in.read(buffer.data() + end, std::streamsize(buffer.size() - end));
+                    end += std::size_t(in.gcount());
+                    eof = !in;
+                }
+            };
 
-                // Try skipping if no match
-                if (max.empty())
+            while (true)
+            {
+                if (!eof && end - position < window / 2)
+                    refill();
+
+                std::string_view rest{buffer.data() + position, end - position};
+                if (rest.empty())
+                    break;
+
+                auto match = next(rest);
+                bool open = false; // the lexeme could continue in the unread input
+                if (!eof && match)
+                    open = match->length == rest.length() || mayExtend(rest);
+                else if (!eof)
                 {
-                    for (const auto &terminal : skipSymbols)
-                    {
-                        Lang::String temp = match(terminal, input);
-                        if (temp.length() > max.length())
-                        {
-                            max = temp;
-                            max_terminal = terminal;
-                        }
-                    }
+                    auto read = examined(rest);
+                    open = read == std::numeric_limits<std::size_t>::max() ? rest.length() < window / 2 : read > rest.length();
+                }
+                if (open)
+                {
+                    refill();
+                    continue;
+                }
+                if (!match)
+                {
+                    lines.append({buffer.data(), position + 1});
+                    unexpectedInput(lines.locate(base + position), rest);
+                }
+
+                if (!match->skip)
+                    co_yield makeToken(*match, rest, base + position);
+                position += match->length;
+            }
+
+            co_yield Token{DOLLAR, "", base + position};
+        }
 
-                    if (!max.empty())
+        // Scanner for input arriving in pieces. A lexeme is only emitted once some text
+        // follows it, since more input could still extend it; the rest stays buffered until
+        // the next feed() or finish().
+        class ChunkScanner
+        {
+        private:
+            const Lexer &lexer;
+            Lang::String pending;
+            std::size_t offset = 0; // source offset of pending.front()
+            SourceMap lines;        // of the text before `pending`, trimmed to its last line
+
+            void drain(bool final, auto &&emit)
+            {
+                std::string_view rest = pending;
+                while (!rest.empty())
+                {
+                    auto match = lexer.next(rest);
+                    if (!final && (!match || match->length == rest.length()))
+                        break;
+                    auto consumed = pending.length() - rest.length();
+                    if (!match)
                     {
-                        logger(LogLevel::TRACE, 2) << "Skipping: '" << max << "'";
-                        column += max.length();
-                        input = input.substr(max.length());
-                        continue;
+                        lines.append(std::string_view{pending}.substr(0, consumed + 1));
+                        lexer.unexpectedInput(lines.locate(offset + consumed), rest);
                     }
+
+                    if (!match->skip)
+                        emit(lexer.makeToken(*match, rest, offset + consumed));
+                    rest.remove_prefix(match->length);
                 }
+                auto consumed = pending.length() - rest.length();
+                lines.append(std::string_view{pending}.substr(0, consumed));
+                offset += consumed;
+                lines.trim(offset);
+                pending.erase(0, consumed);
+            }
+
+        public:
+            explicit ChunkScanner(const Lexer &lexer) : lexer(lexer) {}
+
+            void feed(std::string_view chunk, auto &&emit)
+            {
+                pending.append(chunk);
+                drain(false, emit);
+            }
 
-                // Still no match: unexpected input
-                if (max.empty())
+            // Flushes the buffered tail and emits DOLLAR.
+            void finish(auto &&emit)
+            {
+                drain(true, emit);
+                emit(Token{DOLLAR, "", offset});
+            }
+
+            std::size_t buffered() const noexcept { return pending.length(); }
+        };
+
+        // Token range replaced by relex(): `removed` old tokens from `first` became `inserted` new ones.
+        struct Relex
+        {
+            std::size_t first = 0;
+            std::size_t removed = 0;
+            std::size_t inserted = 0;
+        };
+
+        // Where an old token lay in the text before an edit, as rescan() reads it.
+        struct Extent
+        {
+            std::size_t offset;
+            std::size_t length;
+        };
+
+        // Lexemes of `source`, the text after `edit`, replacing old tokens from `first` on:
+        // `extent(i)` gives old token i of `count`, the last being DOLLAR. `first` must be the
+        // earliest old token whose reach (Token::getReach) got to edit.offset, so lexing
+        // resumes where its region, the text after the token before it, starts. It stops at
+        // the first region boundary past the edit where an old region starts: from there on
+        // both streams are the same. Otherwise the new tokens end with a new DOLLAR.
+        template <typename OldExtent>
+        std::pair<Relex, std::vector<Token>> rescan(std::string_view source, const TextEdit &edit, std::size_t first,
+                                                     std::size_t count, OldExtent &&extent) const
+        {
+            auto endOf = [&](std::size_t i)
+            {
+                auto e = extent(i);
+                return e.offset + e.length;
+            };
+
+            auto delta = std::ptrdiff_t(edit.inserted.length()) - std::ptrdiff_t(edit.removed);
+            std::size_t unchanged = edit.offset + edit.removed; // old text from here on is kept
+            std::size_t boundary = first == 0 ? 0 : first - 1;  // next old region end to line up with
+            std::size_t resync = count;
+            auto synced = [&](std::size_t position)
+            {
+                for (; boundary + 1 < count; ++boundary)
                 {
-                    Lang::String description = std::format("🛑 Unexpected input at {}:{} → {}", line, column, input.substr(0, 10));
-                    logger(LogLevel::ERROR, 1) << description;
-                    throw IStudio::Exception::UnexpectedInputException{description};
+                    auto end = endOf(boundary);
+                    if (std::ptrdiff_t(end) + delta > std::ptrdiff_t(position))
+                        return false;
+                    if (std::ptrdiff_t(end) + delta == std::ptrdiff_t(position) && end >= unchanged)
+                    {
+                        resync = boundary + 1;
+                        return true;
+                    }
                 }
+                return false;
+            };
 
-                // Create token
-                logger(LogLevel::DEBUG, 2) << "Token: [" << max_terminal.getName() << "] = '" << max << "'";
-                result.push_back(Token{max_terminal, max, column, line});
+            auto fresh = lexRegions(source, first == 0 ? 0 : endOf(first - 1), synced);
 
-                // Advance
-                column += max.length();
-                input = input.substr(max.length());
+            if (logger.shouldLog(LogLevel::DEBUG, 2))
+                logger(LogLevel::DEBUG, 2) << "Relexed " << fresh.size() << " tokens in place of " << (resync - first);
+
+            Relex relexed{first, resync - first, fresh.size()};
+            return {relexed, std::move(fresh)};
+        }
+
+        // tokenize() that also records each token's reach, which relex() works from.
+        std::vector<Token> tokenizeWithReach(std::string_view source) const
+        {
+            return lexRegions(source, 0, [](std::size_t) { return false; });
+        }
+
+        // Updates `tokens`, the buffer of the text before `edit`, to `source`, the text after
+        // it, with rescan(). Shifting the tail makes this linear in the buffer length. Tokens
+        // without a reach, as tokenize() makes them, are all lexed again.
+        Relex relex(std::vector<Token> &tokens, std::string_view source, const TextEdit &edit) const
+        {
+            if (tokens.empty() || tokens.back().getReach() == 0)
+            {
+                auto removed = tokens.size();
+                tokens = tokenizeWithReach(source);
+                return {0, removed, tokens.size()};
             }
 
-            logger(LogLevel::INFO, 1) << "✅ Tokenization complete. Total tokens: " << result.size();
+            auto reaches = [&](const Token &t) { return Token::reachEnd(t.getOffset(), t.getReach()) > edit.offset; };
+            std::size_t first = std::size_t(std::find_if(tokens.begin(), tokens.end(), reaches) - tokens.begin());
+            auto [relexed, fresh] = rescan(source, edit, first, tokens.size(), [&](std::size_t i)
+                                           { return Extent{tokens[i].getOffset(), tokens[i].getCode().length()}; });
 
-            // End of input marker
-            result.push_back(Token{DOLLAR, "", column, line});
+            auto delta = std::ptrdiff_t(edit.inserted.length()) - std::ptrdiff_t(edit.removed);
+            auto resync = tokens.begin() + (relexed.first + relexed.removed);
+            for (auto it = resync; it != tokens.end(); ++it)
+                it->moveBy(delta);
+            tokens.erase(tokens.begin() + relexed.first, resync);
+            tokens.insert(tokens.begin() + relexed.first, std::make_move_iterator(fresh.begin()), std::make_move_iterator(fresh.end()));
+            return relexed;
+        }
+
+        std::vector<Token> tokenize(Lang::String input) const
+        {
+            std::vector<Token> result;
+            for (const Token &token : tokens(std::move(input)))
+                result.push_back(token);
+            return result;
+        }
+
+        static constexpr std::size_t DEFAULT_CHUNK_SIZE = 256 * 1024;
+
+        // tokenize() for large inputs. The input is cut into chunks that are lexed
+        // concurrently, each assuming its first byte starts a lexeme. The results are then
+        // stitched in order: the true stream arriving from the previous chunk is relexed
+        // sequentially only until it lands on a lexeme start the chunk also found; the chunk's
+        // tokens are taken from there, since scanning from the same boundary always yields
+        // the same lexemes.
+        std::vector<Token> tokenizeParallel(std::string_view input, Util::ThreadPool &pool = Util::ThreadPool::shared(),
+                                            std::size_t chunkSize = DEFAULT_CHUNK_SIZE) const
+        {
+            chunkSize = std::max<std::size_t>(chunkSize, 1);
+            std::size_t chunks = (input.length() + chunkSize - 1) / chunkSize;
+            if (chunks < 2 || pool.size() < 2)
+            {
+                std::vector<Token> result;
+                for (const Token &token : tokensIn(input))
+                    result.push_back(token);
+                return result;
+            }
+
+            std::vector<Speculation> speculations(chunks);
+            pool.parallelFor(chunks, [&](std::size_t chunk, std::size_t)
+                             { speculations[chunk] = speculate(input, chunk * chunkSize, std::min(input.length(), (chunk + 1) * chunkSize)); });
+
+            std::vector<Token> result;
+            std::size_t position = 0, relexed = 0;
+            auto lexOne = [&]
+            {
+                auto rest = input.substr(position);
+                auto match = next(rest);
+                if (!match)
+                    unexpectedInput(input, position);
+                if (!match->skip)
+                    result.push_back(makeToken(*match, rest, position));
+                position += match->length;
+                ++relexed;
+            };
+
+            for (auto &speculation : speculations)
+            {
+                const auto &boundaries = speculation.boundaries;
+                auto synced = std::lower_bound(boundaries.begin(), boundaries.end(), position);
+                while (position < speculation.end && (synced == boundaries.end() || *synced != position))
+                {
+                    lexOne();
+                    synced = std::lower_bound(synced, boundaries.end(), position);
+                }
+                if (position < speculation.end)
+                {
+                    auto first = speculation.tokens.begin() + speculation.tokensBefore[synced - boundaries.begin()];
+                    result.insert(result.end(), std::make_move_iterator(first), std::make_move_iterator(speculation.tokens.end()));
+                    position = speculation.end;
+                }
+            }
+            while (position < input.length())
+                lexOne();
+
+            if (logger.shouldLog(LogLevel::DEBUG, 2))
+                logger(LogLevel::DEBUG, 2) << "Parallel tokenization: " << chunks << " chunks, " << relexed << " lexemes relexed";
+
+            result.emplace_back(DOLLAR, "", input.length());
             return result;
         }
 
+        // `code | lexer` is lazy: tokens are produced as the next stage pulls them.
         friend auto operator|(Lang::String input, const Lexer &l)
         {
-            return l.tokenize(input);
+            return l.tokens(std::move(input));
         }
     };
 
@@ -0,0 +1,329 @@
+#pragma once
+
+#include "Types_Compiler.hpp"
+#include "Lang.hpp"
+#include "Symbol.hpp"
+#include "Exception.hpp"
+
+namespace IStudio::Compiler
+{
+    // Unescaped text of a string literal: `length` bytes at `offset` in the token's lexeme
+    // or, when `pooled`, in the lexer's LiteralArena. See Lexer::literalText.
+    struct StringLiteral
+    {
+        std::uint32_t offset;
+        std::uint32_t length : 31;
+        std::uint32_t pooled : 1;
+    };
+
+    // Value of a literal token, decoded once by the lexer: integer and floating literals
+    // as numbers, a character literal as its code point, a string literal as a handle of
+    // its unescaped text. std::monostate for other tokens and for literals that do not
+    // decode.
+    using LiteralValue = std::variant<std::monostate, std::int64_t, double, char32_t, StringLiteral>;
+
+    // Unescaped string literals that differ from their lexeme, stored back to back in
+    // blocks that never move. Lexers on several threads may store into one arena.
+    class LiteralArena
+    {
+    private:
+        static constexpr std::size_t BLOCK_SIZE = 16 * 1024;
+
+        mutable std::shared_mutex mutex;
+        std::vector<std::unique_ptr<char[]>> storage;
+        std::vector<char *> blocks; // by offset / BLOCK_SIZE
+        std::size_t used = 0;       // bytes handed out, gaps at block ends included
+
+    public:
+        LiteralArena() = default;
+        LiteralArena(const LiteralArena &) = delete;
+        LiteralArena &operator=(const LiteralArena &) = delete;
+
+        // Offset of a copy of `text`.
+        std::uint32_t store(std::string_view text)
+        {
+            std::unique_lock lock{mutex};
+            if (used % BLOCK_SIZE + text.length() > BLOCK_SIZE || used == blocks.size() * BLOCK_SIZE)
+            {
+                // a text longer than a block gets consecutive blocks of its own
+                auto count = std::max<std::size_t>(1, (text.length() + BLOCK_SIZE - 1) / BLOCK_SIZE);
+                used = blocks.size() * BLOCK_SIZE;
+                if (used + count * BLOCK_SIZE > std::numeric_limits<std::uint32_t>::max())
+                    throw IStudio::Exception::RuntimeException{"Literal arena is full"};
+                storage.push_back(std::make_unique<char[]>(count * BLOCK_SIZE));
+                for (std::size_t i = 0; i < count; ++i)
+                    blocks.push_back(storage.back().get() + i * BLOCK_SIZE);
+            }
+            auto offset = used;
+            std::memcpy(blocks[offset / BLOCK_SIZE] + offset % BLOCK_SIZE, text.data(), text.length());
+            used += text.length();
+            return std::uint32_t(offset);
+        }
+
+        std::string_view text(std::uint32_t offset, std::size_t length) const
+        {
+            if (length == 0)
+                return {};
+            std::shared_lock lock{mutex};
+            return {blocks.at(offset / BLOCK_SIZE) + offset % BLOCK_SIZE, length};
+        }
+    };
+
+    // Decoding of literal lexemes by their terminal's LiteralType. Integers take an
+    // optional sign, a 0x, 0o or 0b prefix or a leading 0 for octal, and u/l/z suffixes;
+    // floating literals one f/l suffix. Character and string literals are quoted and take
+    // the C escapes, with \u and \U giving UTF-8.
+    class Literal
+    {
+    private:
+        static int digitValue(char c)
+        {
+            if (c >= '0' && c <= '9')
+                return c - '0';
+            if (c >= 'a' && c <= 'z')
+                return c - 'a' + 10;
+            if (c >= 'A' && c <= 'Z')
+                return c - 'A' + 10;
+            return 99;
+        }
+
+        static std::string_view withoutSuffix(std::string_view text, std::string_view suffixes)
+        {
+            while (!text.empty() && suffixes.find(text.back()) != std::string_view::npos)
+                text.remove_suffix(1);
+            return text;
+        }
+
+        // Text between matching quotes, or nullopt.
+        static std::optional<std::string_view> unquote(std::string_view text, char quote)
+        {
+            if (text.length() < 2 || text.front() != quote || text.back() != quote)
+                return std::nullopt;
+            return text.substr(1, text.length() - 2);
+        }
+
+        static void appendUtf8(std::string &out, char32_t c)
+        {
+            if (c < 0x80)
+                out += char(c);
+            else if (c < 0x800)
+                out += {char(0xC0 | (c >> 6)), char(0x80 | (c & 0x3F))};
+            else if (c < 0x10000)
+                out += {char(0xE0 | (c >> 12)), char(0x80 | ((c >> 6) & 0x3F)), char(0x80 | (c & 0x3F))};
+            else
+                out += {char(0xF0 | (c >> 18)), char(0x80 | ((c >> 12) & 0x3F)), char(0x80 | ((c >> 6) & 0x3F)), char(0x80 | (c & 0x3F))};
+        }
+
+        // Up to `count` digits of `base` at `i`; nullopt if there is none or `exact` and fewer.
+        static std::optional<char32_t> digits(std::string_view body, std::size_t &i, int base, std::size_t count, bool exact)
+        {
+            char32_t value = 0;
+            std::size_t taken = 0;
+            while (taken < count && i < body.length() && digitValue(body[i]) < base)
+            {
+                value = value * char32_t(base) + char32_t(digitValue(body[i++]));
+                ++taken;
+            }
+            if (taken == 0 || (exact && taken < count))
+                return std::nullopt;
+            return value;
+        }
+
+        // Quoted text with its escapes replaced; false on a malformed escape.
+        static bool unescape(std::string_view body, std::string &out)
+        {
+            out.reserve(body.length());
+            for (std::size_t i = 0; i < body.length();)
+            {
+                if (body[i] != '\\')
+                {
+                    auto plain = body.find('\\', i);
+                    out.append(body.substr(i, plain - i));
+                    i = plain == std::string_view::npos ? body.length() : plain;
+                    continue;
+                }
+                if (++i == body.length())
+                    return false;
+                char c = body[i++];
+                std::optional<char32_t> code;
+                switch (c)
+                {
+                case 'n': out += '\n'; continue;
+                case 't': out += '\t'; continue;
+                case 'r': out += '\r'; continue;
+                case 'a': out += '\a'; continue;
+                case 'b': out += '\b'; continue;
+                case 'f': out += '\f'; continue;
+                case 'v': out += '\v'; continue;
+                case 'x': code = digits(body, i, 16, 2, false); break;
+                case 'u': code = digits(body, i, 16, 4, true); break;
+                case 'U': code = digits(body, i, 16, 8, true); break;
+                default:
+                    if (c >= '0' && c <= '7')
+                    {
+                        --i;
+                        code = digits(body, i, 8, 3, false);
+                        break;
+                    }
+                    out += c; // \\ \' \" \? and any other character stand for themselves
+                    continue;
+                }
+                if (!code || *code > 0x10FFFF)
+                    return false;
+                if (c == 'x' || (c >= '0' && c <= '7'))
+                {
+                    if (*code > 0xFF)
+                        return false;
+                    out += char(*code); // a byte, not a code point
+                }
+                else
+                    appendUtf8(out, *code);
+            }
+            return true;
+        }
+
+        // The single byte, or the single code point in UTF-8, that `text` holds.
+        static std::optional<char32_t> codePoint(std::string_view text)
+        {
+            if (text.length() == 1)
+                return char32_t((unsigned char)text.front());
+            auto lead = (unsigned char)(text.empty() ? 0 : text.front());
+            std::size_t length = lead >= 0xF0 ? 4 : lead >= 0xE0 ? 3 : lead >= 0xC0 ? 2 : 0;
+            if (length == 0 || length != text.length())
+                return std::nullopt;
+            char32_t value = lead & (0x7F >> length);
+            for (std::size_t i = 1; i < length; ++i)
+                value = value << 6 | ((unsigned char)text[i] & 0x3F);
+            return value;
+        }
+
+    public:
+        static std::optional<std::int64_t> integer(std::string_view text)
+        {
+            text = withoutSuffix(text, "uUlLzZ");
+            char sign = '+';
+            if (!text.empty() && (text.front() == '-' || text.front() == '+'))
+            {
+                sign = text.front();
+                text.remove_prefix(1);
+            }
+
+            int base = 10;
+            if (text.length() > 2 && text[0] == '0')
+            {
+                switch (text[1])
+                {
+                case 'x': case 'X': base = 16; break;
+                case 'o': case 'O': base = 8; break;
+                case 'b': case 'B': base = 2; break;
+                }
+                if (base != 10)
+                    text.remove_prefix(2);
+            }
+            if (base == 10 && text.length() > 1 && text[0] == '0')
+                base = 8; // C's 017
+
+            std::uint64_t magnitude = 0;
+            auto [end, error] = std::from_chars(text.data(), text.data() + text.length(), magnitude, base);
+            if (error != std::errc{} || end != text.data() + text.length())
+                return std::nullopt;
+            constexpr auto limit = std::uint64_t(std::numeric_limits<std::int64_t>::max());
+            if (sign == '-')
+            {
+                if (magnitude > limit + 1)
+                    return std::nullopt;
+                return std::int64_t(0 - magnitude);
+            }
+            if (magnitude > limit)
+                return std::nullopt;
+            return std::int64_t(magnitude);
+        }
+
+        static std::optional<double> floating(std::string_view text)
+        {
+            if (text.length() > 1 && std::string_view{"fFlL"}.find(text.back()) != std::string_view::npos)
+            {
+                char before = text[text.length() - 2];
+                if ((before >= '0' && before <= '9') || before == '.')
+                    text.remove_suffix(1);
+            }
+            if (!text.empty() && text.front() == '+')
+                text.remove_prefix(1);
+            double value = 0;
+            auto [end, error] = std::from_chars(text.data(), text.data() + text.length(), value);
+            if (error != std::errc{} || end != text.data() + text.length())
+                return std::nullopt;
+            return value;
+        }
+
+        static std::optional<char32_t> character(std::string_view text)
+        {
+            auto body = unquote(text, '\'');
+            std::string decoded;
+            if (!body || !unescape(*body, decoded))
+                return std::nullopt;
+            return codePoint(decoded);
+        }
+
+        // Unescaped text of a "..." or '...' literal.
+        static std::optional<Lang::String> string(std::string_view text)
+        {
+            auto body = unquote(text, '"');
+            if (!body)
+                body = unquote(text, '\'');
+            if (!body)
+                return std::nullopt;
+            if (body->find('\\') == std::string_view::npos)
+                return Lang::String{*body};
+            Lang::String decoded;
+            if (!unescape(*body, decoded))
+                return std::nullopt;
+            return decoded;
+        }
+
+        // Handle of the unescaped text of a string literal `lexeme`: its body when it has no
+        // escapes, else a copy stored in `arena`.
+        static std::optional<StringLiteral> string(std::string_view lexeme, LiteralArena &arena)
+        {
+            if (lexeme.length() > std::size_t(std::numeric_limits<std::int32_t>::max()))
+                return std::nullopt;
+            if (lexeme.find('\\') == std::string_view::npos)
+            {
+                if (!unquote(lexeme, '"') && !unquote(lexeme, '\''))
+                    return std::nullopt;
+                return StringLiteral{1, std::uint32_t(lexeme.length() - 2), false};
+            }
+            auto decoded = string(lexeme);
+            if (!decoded)
+                return std::nullopt;
+            return StringLiteral{arena.store(*decoded), std::uint32_t(decoded->length()), true};
+        }
+
+        static std::string_view text(const StringLiteral &literal, std::string_view lexeme, const LiteralArena &arena)
+        {
+            if (literal.pooled)
+                return arena.text(literal.offset, literal.length);
+            return lexeme.substr(literal.offset, literal.length);
+        }
+
+        // Value of `lexeme` for a terminal of `type`.
+        static LiteralValue decode(LiteralType type, std::string_view lexeme, LiteralArena &arena)
+        {
+            auto value = [](auto decoded) -> LiteralValue
+            {
+                if (decoded)
+                    return *decoded;
+                return std::monostate{};
+            };
+            switch (type)
+            {
+            case LiteralType::INTEGER: return value(integer(lexeme));
+            case LiteralType::FLOATING: return value(floating(lexeme));
+            case LiteralType::CHARACTER: return value(character(lexeme));
+            case LiteralType::STRING: return value(string(lexeme, arena));
+            default: return std::monostate{};
+            }
+        }
+    };
+
+} // namespace IStudio::Compiler
@@ -18,15 +18,13 @@ namespace IStudio::Log
     {
     public:
         Logger()
-            : logFile(nullptr), logLevel(LogLevel::DEBUG), logDepth(1),
-              defaultLogDepth(0), enabled(true),
-              logMessageStream(std::make_shared<std::stringstream>())
+            : logFile(nullptr), writeMutex(std::make_shared<std::mutex>()), logLevel(LogLevel::DEBUG), logDepth(1),
+              defaultLogDepth(0), enabled(true)
         {}
 
         Logger(const std::string &filename, LogLevel level = LogLevel::DEBUG, int depth = 0, int defaultDepth = 0)
-            : logFileName(filename), logLevel(level), logDepth(depth),
-              defaultLogDepth(defaultDepth), enabled(true),
-              logMessageStream(std::make_shared<std::stringstream>())
+            : logFileName(filename), writeMutex(std::make_shared<std::mutex>()), logLevel(level), logDepth(depth),
+              defaultLogDepth(defaultDepth), enabled(true)
         {
             logFile = std::make_shared<std::ofstream>(filename, std::ios::app);
         }
@@ -57,45 +55,45 @@ namespace IStudio::Log
             }
         }
 
-        // Scoped logging wrapper
+        // Scoped logging wrapper. Each message is collected in the wrapper's own buffer and
+        // written on destruction, so log statements on different threads share no state
+        // besides the output, which is guarded by a mutex. Filtered-out messages are never
+        // formatted.
         template <typename T>
         class LogWrapper
         {
         public:
-            LogWrapper(T &logger, LogLevel level, int depth)
+            LogWrapper(const T &logger, LogLevel level, int depth)
                 : logger(logger),
-                  prevLogLevel(logger.logLevel),
-                  prevLogDepth(logger.logDepth)
+                  level(level)
             {
-                logger.logLevel = level;
-                logger.logDepth = depth;
+                if (logger.shouldLog(level, depth))
+                    buffer.emplace();
             }
 
             template <typename U>
             LogWrapper &operator<<(const U &value)
             {
-                *logger.logMessageStream << value;
+                if (buffer)
+                    *buffer << value;
                 return *this;
             }
 
             ~LogWrapper()
             {
-                logger.log(logger.logMessageStream->str());
-                logger.logMessageStream->str("");
-                logger.logLevel = prevLogLevel;
-                logger.logDepth = prevLogDepth;
+                if (buffer)
+                    logger.log(level, buffer->str());
             }
 
         private:
-            T &logger;
-            LogLevel prevLogLevel;
-            int prevLogDepth;
+            const T &logger;
+            LogLevel level;
+            std::optional<std::ostringstream> buffer;
         };
 
-        // const-correct operator() with internal mutable state
         LogWrapper<Logger> operator()(LogLevel level, int depth = 0) const
         {
-            return LogWrapper<Logger>(const_cast<Logger &>(*this), level, depth);
+            return LogWrapper<Logger>(*this, level, depth);
         }
 
         void setDefaultDepth(int depth) { defaultLogDepth = depth; }
@@ -105,6 +103,12 @@ namespace IStudio::Log
         void disable() { enabled = false; }
         bool isEnabled() const { return enabled; }
 
+        // Whether a message at this level and depth would be written; lets hot paths skip formatting.
+        bool shouldLog(LogLevel level, int depth = 0) const
+        {
+            return enabled && depth <= defaultLogDepth && isLogLevelDefault(level);
+        }
+
         LogLevel getLogLevel() const { return logLevel; }
         int getLogDepth() const { return logDepth; }
 
@@ -112,7 +116,7 @@ namespace IStudio::Log
         void setMaxBackupFiles(int count) { maxBackupFiles = count; }
 
     private:
-        std::streamsize getFileSize()
+        std::streamsize getFileSize() const
         {
             if (!logFile || !logFile->is_open()) return 0;
             logFile->flush();
@@ -120,9 +124,11 @@ namespace IStudio::Log
             return in.tellg();
         }
 
-        void rotateLogFile()
+        // Reopens the shared stream in place, so every copy of the logger follows the rotation.
+        void rotateLogFile() const
         {
-            if (logFile) logFile->close();
+            if (!logFile) return;
+            logFile->close();
 
             std::string lastBackup = logFileName + "." + std::to_string(maxBackupFiles);
             std::remove(lastBackup.c_str());
@@ -137,7 +143,7 @@ namespace IStudio::Log
             std::string newName = logFileName + ".1";
             std::rename(logFileName.c_str(), newName.c_str());
 
-            logFile = std::make_shared<std::ofstream>(logFileName, std::ios::trunc);
+            logFile->open(logFileName, std::ios::trunc);
         }
 
         void copyFrom(const Logger &other)
@@ -149,13 +155,12 @@ namespace IStudio::Log
             defaultLogLevel = other.defaultLogLevel;
             logFileName = other.logFileName;
             logFile = other.logFile;
-            logMessageStream = other.logMessageStream;
+            writeMutex = other.writeMutex;
         }
 
-        void log(const std::string &message)
+        void log(LogLevel level, const std::string &message) const
         {
-            if (!enabled || logDepth > defaultLogDepth || !isLogLevelDefault())
-                return;
+            std::lock_guard lock{*writeMutex};
 
             std::time_t now = std::time(nullptr);
             char timeBuffer[20];
@@ -163,7 +168,7 @@ namespace IStudio::Log
 
             std::string logMessage = "[" + std::string(timeBuffer) + "] ";
 
-            switch (logLevel)
+            switch (level)
             {
             case LogLevel::DEBUG: logMessage += "[DEBUG] "; break;
             case LogLevel::INFO: logMessage += "[INFO] "; break;
@@ -192,21 +197,20 @@ namespace IStudio::Log
             }
         }
 
-        bool isLogLevelDefault() const
+        bool isLogLevelDefault(LogLevel level) const
         {
             if (defaultLogLevel.empty()) return true;
             for (const auto &lvl : defaultLogLevel)
-                if (lvl == logLevel) return true;
+                if (lvl == level) return true;
             return false;
         }
 
         std::string logFileName;
         std::shared_ptr<std::ofstream> logFile;
+        std::shared_ptr<std::mutex> writeMutex; // shared by copies, like logFile
 
-        // Marked mutable to allow logging from const contexts
-        mutable std::shared_ptr<std::stringstream> logMessageStream;
-        mutable LogLevel logLevel;
-        mutable int logDepth;
+        LogLevel logLevel;
+        int logDepth;
 
         int defaultLogDepth;
         std::vector<LogLevel> defaultLogLevel;
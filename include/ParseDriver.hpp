@@ -0,0 +1,321 @@
+#pragma once
+
+#include "Types_Compiler.hpp"
+#include "ParseTable.hpp"
+#include "token.hpp"
+#include "Exception.hpp"
+#include "Logger.hpp"
+
+namespace IStudio::Compiler
+{
+    // A builder turns shifted tokens and reductions into the values kept on the driver's value stack.
+    // One that also defines pushed(value, state) is told the state below each value the
+    // driver pushes.
+    template <typename B>
+    concept ParseBuilder = requires(B builder, const Token &token, std::size_t index,
+                                    const ParseTable::RuleInfo &rule, std::span<typename B::value_type> children) {
+        typename B::value_type;
+        { builder.shift(token, index) } -> std::convertible_to<typename B::value_type>;
+        { builder.reduce(rule, children) } -> std::convertible_to<typename B::value_type>;
+    };
+
+    // Table-driven shift/reduce loop over an integer state stack and a value stack.
+    // Both stacks are reserved up front and reused, so a steady-state step allocates
+    // nothing beyond what the builder creates.
+    template <ParseBuilder Builder>
+    class ParseDriver
+    {
+    public:
+        using value_type = typename Builder::value_type;
+
+        enum class Status
+        {
+            PENDING,
+            ACCEPTED
+        };
+
+    private:
+        const ParseTable &table;
+        Builder &builder;
+        const IStudio::Log::Logger &logger;
+        bool collapseUnitChains;
+
+        std::vector<ParseTable::StateId> stateStack;
+        std::vector<value_type> valueStack;
+        std::size_t tokenIndex = 0;
+        Status status = Status::PENDING;
+
+        [[noreturn]] void fail(const std::string &message) const
+        {
+            logger(IStudio::Log::LogLevel::ERROR, 1) << message;
+            throw IStudio::Exception::ParserException{message};
+        }
+
+        void push(ParseTable::StateId state, value_type value)
+        {
+            if constexpr (requires { builder.pushed(value, state); })
+                builder.pushed(value, stateStack.back());
+            stateStack.push_back(state);
+            valueStack.push_back(std::move(value));
+        }
+
+        // State reached by pushing `nonterminal` onto the current state, after the unit
+        // chain `lookahead` runs from there (wrapping `value` unless chains are collapsed),
+        // or NO_STATE.
+        ParseTable::StateId advance(ParseTable::SymbolId nonterminal, ParseTable::SymbolId lookahead, value_type &value)
+        {
+            auto exposed = stateStack.back();
+            const auto *chain = table.getUnitChain(exposed, nonterminal, lookahead);
+            if (!chain)
+                return table.getGoto(exposed, nonterminal);
+
+            // Skip the intermediate unit reductions and their GOTO lookups.
+            for (auto unitId : chain->rules)
+            {
+                if (logger.shouldLog(IStudio::Log::LogLevel::DEBUG, 2))
+                    logger(IStudio::Log::LogLevel::DEBUG, 2) << "REDUCE (unit chain): " << table.getRule(unitId).rule;
+                if (!collapseUnitChains)
+                    value = builder.reduce(table.getRule(unitId), std::span<value_type>{&value, 1});
+            }
+            return chain->target;
+        }
+
+        void reduce(ParseTable::RuleId ruleId, ParseTable::SymbolId lookahead)
+        {
+            const auto &rule = table.getRule(ruleId);
+            if (logger.shouldLog(IStudio::Log::LogLevel::DEBUG, 2))
+                logger(IStudio::Log::LogLevel::DEBUG, 2) << "REDUCE: " << rule.rule;
+
+            if (valueStack.size() < rule.length)
+                fail("Not enough AST nodes to reduce.");
+
+            auto first = valueStack.end() - rule.length;
+            value_type value = builder.reduce(rule, std::span<value_type>{first, valueStack.end()});
+            valueStack.erase(first, valueStack.end());
+            stateStack.resize(stateStack.size() - rule.length);
+
+            auto next = advance(rule.left, lookahead, value);
+            if (next == ParseTable::NO_STATE)
+                fail("No valid state transition after reduce.");
+            push(next, std::move(value));
+        }
+
+        // Runs the reductions `terminal` triggers and returns the action after them, or
+        // nullptr if the terminal has no action in the state reached.
+        const ParseTable::Action *resolve(ParseTable::SymbolId terminal)
+        {
+            while (true)
+            {
+                const auto &action = table.getAction(stateStack.back(), terminal);
+                if (action.kind == ParseTable::ActionKind::REDUCE)
+                {
+                    // Only a driver started with resetTo() can lack the states below its base.
+                    if (table.getRule(action.value).length >= stateStack.size())
+                        return nullptr;
+                    reduce(action.value, terminal);
+                }
+                else if (action.kind == ParseTable::ActionKind::ERROR)
+                    return nullptr;
+                else
+                    return &action;
+            }
+        }
+
+        Status apply(const ParseTable::Action &action, const Token &token)
+        {
+            if (action.kind == ParseTable::ActionKind::ACCEPT)
+            {
+                logger(IStudio::Log::LogLevel::INFO, 1) << "ACCEPT";
+                status = Status::ACCEPTED;
+                return status;
+            }
+
+            if (logger.shouldLog(IStudio::Log::LogLevel::DEBUG, 2))
+                logger(IStudio::Log::LogLevel::DEBUG, 2) << "SHIFT";
+            push(action.value, builder.shift(token, tokenIndex++));
+            return status;
+        }
+
+        std::optional<ParseTable::SymbolId> terminalId(const Token &token) const
+        {
+            auto id = table.getSymbolId(token.getTerminal());
+            if (!id || !table.isTerminal(*id))
+                return std::nullopt;
+            return id;
+        }
+
+    public:
+        ParseDriver(const ParseTable &table, Builder &builder, const IStudio::Log::Logger &logger,
+                    bool collapseUnitChains = false, std::size_t capacity = 256)
+            : table(table), builder(builder), logger(logger), collapseUnitChains(collapseUnitChains)
+        {
+            stateStack.reserve(capacity);
+            valueStack.reserve(capacity);
+            stateStack.push_back(table.getStartState());
+        }
+
+        // Runs every reduction `token` triggers as lookahead and returns the action that
+        // follows them (SHIFT or ACCEPT) without applying it.
+        const ParseTable::Action &reduceOn(const Token &token)
+        {
+            auto id = terminalId(token);
+            const ParseTable::Action *action = id ? resolve(*id) : nullptr;
+            if (!action)
+                fail("No valid action for terminal: " + std::string{token.getTerminal().getName()});
+            return *action;
+        }
+
+        // Runs every reduction the token triggers, then shifts it (or accepts).
+        Status feed(const Token &token)
+        {
+            if (status == Status::ACCEPTED)
+                return status;
+
+            if (logger.shouldLog(IStudio::Log::LogLevel::DEBUG, 2))
+                logger(IStudio::Log::LogLevel::DEBUG, 2) << "Parsing token: " << token.getTerminal();
+
+            return apply(reduceOn(token), token);
+        }
+
+        // feed() for error recovery: a token without an action yields nullopt instead of
+        // an exception. Canonical LR(1) detects the error before reducing, so the stacks
+        // are left as they were.
+        std::optional<Status> tryFeed(const Token &token)
+        {
+            if (status == Status::ACCEPTED)
+                return status;
+
+            auto id = terminalId(token);
+            const ParseTable::Action *action = id ? resolve(*id) : nullptr;
+            if (!action)
+                return std::nullopt;
+            return apply(*action, token);
+        }
+
+        // Terminals with an action in the current state, for "expected ..." messages.
+        std::vector<ParseTable::SymbolId> expectedTerminals() const
+        {
+            std::vector<ParseTable::SymbolId> expected;
+            for (ParseTable::SymbolId terminal = 0; terminal < table.getTerminalCount(); ++terminal)
+            {
+                if (table.getAction(stateStack.back(), terminal).kind != ParseTable::ActionKind::ERROR)
+                    expected.push_back(terminal);
+            }
+            return expected;
+        }
+
+        // Panic-mode recovery: pops states (and their values) until `terminal` has an action.
+        // Returns false, leaving only the start state, if no state on the stack has one.
+        bool recoverTo(ParseTable::SymbolId terminal)
+        {
+            while (table.getAction(stateStack.back(), terminal).kind == ParseTable::ActionKind::ERROR)
+            {
+                if (stateStack.size() == 1)
+                    return false;
+                stateStack.pop_back();
+                valueStack.pop_back();
+            }
+            return true;
+        }
+
+        // Pushes an already built subtree for `nonterminal` covering `tokenCount` tokens,
+        // as if its tokens had just been parsed from the current state and `lookahead`
+        // followed them.
+        void shiftNonterminal(ParseTable::SymbolId nonterminal, value_type value, std::size_t tokenCount, const Token &lookahead)
+        {
+            auto id = terminalId(lookahead);
+            auto next = id ? advance(nonterminal, *id, value) : ParseTable::NO_STATE;
+            if (next == ParseTable::NO_STATE)
+                fail("No valid state transition for reused subtree.");
+
+            push(next, std::move(value));
+            tokenIndex += tokenCount;
+        }
+
+        ParseTable::StateId currentState() const noexcept { return stateStack.back(); }
+        std::span<const ParseTable::StateId> states() const noexcept { return stateStack; }
+        std::span<const value_type> values() const noexcept { return valueStack; }
+        std::size_t getTokenIndex() const noexcept { return tokenIndex; }
+
+        struct Snapshot
+        {
+            std::vector<ParseTable::StateId> states;
+            std::vector<value_type> values;
+            std::size_t tokenIndex;
+        };
+
+        Snapshot snapshot() const
+        {
+            return {stateStack, valueStack, tokenIndex};
+        }
+
+        void restore(const Snapshot &snapshot)
+        {
+            stateStack.assign(snapshot.states.begin(), snapshot.states.end());
+            valueStack.assign(snapshot.values.begin(), snapshot.values.end());
+            tokenIndex = snapshot.tokenIndex;
+            status = Status::PENDING;
+        }
+
+        void restore(Snapshot &&snapshot)
+        {
+            stateStack = std::move(snapshot.states);
+            valueStack = std::move(snapshot.values);
+            tokenIndex = snapshot.tokenIndex;
+            status = Status::PENDING;
+        }
+
+        // Starts a parse of a token range on its own, from `base` instead of the start state.
+        void resetTo(ParseTable::StateId base, std::size_t firstToken)
+        {
+            stateStack.assign(1, base);
+            valueStack.clear();
+            tokenIndex = firstToken;
+            status = Status::PENDING;
+        }
+
+        // Moves the stacks out, e.g. to splice() them into another driver.
+        Snapshot release()
+        {
+            Snapshot result{std::move(stateStack), std::move(valueStack), tokenIndex};
+            reset();
+            return result;
+        }
+
+        // Appends a range parsed separately from the current state (segment.states.front()).
+        void splice(Snapshot &&segment)
+        {
+            stateStack.insert(stateStack.end(), segment.states.begin() + 1, segment.states.end());
+            valueStack.insert(valueStack.end(), std::make_move_iterator(segment.values.begin()),
+                              std::make_move_iterator(segment.values.end()));
+            tokenIndex = segment.tokenIndex;
+        }
+
+        bool accepted() const noexcept { return status == Status::ACCEPTED; }
+
+        // Root of the parse once accepted; moved out of the value stack.
+        value_type result()
+        {
+            return std::move(valueStack.back());
+        }
+
+        // Result of a finished input; fails if the parser never reached ACCEPT.
+        value_type finish()
+        {
+            if (!accepted())
+                fail("Input not fully parsed.");
+            return result();
+        }
+
+        // Clears the stacks for another parse while keeping their capacity.
+        void reset()
+        {
+            stateStack.clear();
+            valueStack.clear();
+            stateStack.push_back(table.getStartState());
+            tokenIndex = 0;
+            status = Status::PENDING;
+        }
+    };
+
+} // namespace IStudio::Compiler
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "Types_Compiler.hpp"
+#include "ParseTable.hpp"
+#include "token.hpp"
+
+namespace IStudio::Compiler
+{
+    // Receives the parse as a stream of shift/reduce events instead of a tree.
+    class ParseEventSink
+    {
+    public:
+        virtual ~ParseEventSink() = default;
+
+        virtual void shift(std::size_t tokenIndex) = 0;
+        virtual void reduce(ParseTable::RuleId rule, std::uint32_t length) = 0;
+        virtual void accept() {}
+    };
+
+    // Sink packing each event into one 64-bit word: the low bit tells shift (0) from
+    // reduce (1); shifts keep the token index above it, reduces the rule id and length.
+    class ParseEventBuffer : public ParseEventSink
+    {
+    private:
+        std::vector<std::uint64_t> events;
+
+    public:
+        void shift(std::size_t tokenIndex) override
+        {
+            events.push_back(std::uint64_t(tokenIndex) << 1);
+        }
+
+        void reduce(ParseTable::RuleId rule, std::uint32_t length) override
+        {
+            events.push_back((std::uint64_t(rule) << 33) | (std::uint64_t(length) << 1) | 1);
+        }
+
+        static bool isReduce(std::uint64_t event) noexcept { return event & 1; }
+        static std::size_t tokenIndex(std::uint64_t event) noexcept { return std::size_t(event >> 1); }
+        static ParseTable::RuleId rule(std::uint64_t event) noexcept { return ParseTable::RuleId(event >> 33); }
+        static std::uint32_t length(std::uint64_t event) noexcept { return std::uint32_t(event >> 1); }
+
+        const std::vector<std::uint64_t> &getEvents() const noexcept { return events; }
+        void clear() noexcept { events.clear(); }
+    };
+
+    // ParseDriver builder forwarding to a sink; the value stack carries no data.
+    class ParseEventBuilder
+    {
+    private:
+        ParseEventSink &sink;
+
+    public:
+        using value_type = std::monostate;
+
+        explicit ParseEventBuilder(ParseEventSink &sink) : sink(sink) {}
+
+        value_type shift([[maybe_unused]] const Token &token, std::size_t index)
+        {
+            sink.shift(index);
+            return {};
+        }
+
+        value_type reduce(const ParseTable::RuleInfo &rule, std::span<value_type> children)
+        {
+            sink.reduce(rule.id, std::uint32_t(children.size()));
+            return {};
+        }
+    };
+
+} // namespace IStudio::Compiler
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "Types_Compiler.hpp"
+#include "ParseTable.hpp"
+
+namespace IStudio::Compiler
+{
+    // Shared packed parse forest produced by the GLR driver. A node stands for one symbol
+    // over the token range [start, end); every way of deriving it is one family of children.
+    // Nodes are shared between all derivations that use them, so an ambiguous input is kept
+    // in space polynomial in its length.
+    class ParseForest
+    {
+    public:
+        using NodeId = std::uint32_t;
+
+        struct Family
+        {
+            ParseTable::RuleId rule;
+            std::vector<NodeId> children;
+        };
+
+        struct Node
+        {
+            ParseTable::SymbolId symbol;
+            std::uint32_t start;
+            std::uint32_t end;
+            std::vector<Family> families; // empty for token leaves
+        };
+
+    private:
+        std::vector<Node> nodes;
+
+    public:
+        NodeId addLeaf(ParseTable::SymbolId terminal, std::uint32_t tokenIndex)
+        {
+            nodes.push_back({terminal, tokenIndex, tokenIndex + 1, {}});
+            return NodeId(nodes.size() - 1);
+        }
+
+        NodeId addNode(ParseTable::SymbolId symbol, std::uint32_t start, std::uint32_t end)
+        {
+            nodes.push_back({symbol, start, end, {}});
+            return NodeId(nodes.size() - 1);
+        }
+
+        // Adds a derivation of `node`; returns false if it was already there.
+        bool addFamily(NodeId node, ParseTable::RuleId rule, std::vector<NodeId> children)
+        {
+            auto &families = nodes[node].families;
+            for (const auto &family : families)
+            {
+                if (family.rule == rule && family.children == children)
+                    return false;
+            }
+            families.push_back({rule, std::move(children)});
+            return true;
+        }
+
+        const Node &getNode(NodeId id) const { return nodes[id]; }
+        bool isLeaf(NodeId id) const { return nodes[id].families.empty(); }
+        bool isAmbiguous(NodeId id) const { return nodes[id].families.size() > 1; }
+
+        std::size_t size() const noexcept { return nodes.size(); }
+        void clear() noexcept { nodes.clear(); }
+
+        std::size_t ambiguousNodes() const noexcept
+        {
+            return std::size_t(std::count_if(nodes.begin(), nodes.end(), [](const Node &n)
+                                             { return n.families.size() > 1; }));
+        }
+
+        // Number of distinct trees packed under `root`, saturating at the uint64 maximum.
+        std::uint64_t countTrees(NodeId root) const
+        {
+            std::vector<std::uint64_t> counts(nodes.size(), 0);
+            std::vector<bool> done(nodes.size(), false);
+            return countTrees(root, counts, done);
+        }
+
+    private:
+        std::uint64_t countTrees(NodeId id, std::vector<std::uint64_t> &counts, std::vector<bool> &done) const
+        {
+            constexpr auto MAX = std::numeric_limits<std::uint64_t>::max();
+            if (done[id])
+                return counts[id];
+            done[id] = true; // a cyclic derivation contributes no finite tree
+
+            if (nodes[id].families.empty())
+                return counts[id] = 1;
+
+            std::uint64_t total = 0;
+            for (const auto &family : nodes[id].families)
+            {
+                std::uint64_t product = 1;
+                for (auto child : family.children)
+                {
+                    auto count = countTrees(child, counts, done);
+                    product = (count != 0 && product > MAX / count) ? MAX : product * count;
+                }
+                total = (total > MAX - product) ? MAX : total + product;
+            }
+            return counts[id] = total;
+        }
+    };
+
+} // namespace IStudio::Compiler
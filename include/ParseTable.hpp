@@ -0,0 +1,124 @@
+#pragma once
+
+#include "Types_Compiler.hpp"
+#include "Symbol.hpp"
+#include "Terminal.hpp"
+#include "Rule.hpp"
+
+namespace IStudio::Compiler
+{
+    // Integer-indexed LR tables compiled from the Parser's item-set automaton.
+    // Terminals (including DOLLAR) are numbered first, nonterminals follow them.
+    class ParseTable
+    {
+    public:
+        using StateId = std::uint32_t;
+        using SymbolId = std::uint32_t;
+        using RuleId = std::uint32_t;
+
+        static constexpr StateId NO_STATE = std::numeric_limits<StateId>::max();
+
+        enum class ActionKind : std::uint8_t
+        {
+            ERROR,
+            SHIFT,
+            REDUCE,
+            ACCEPT
+        };
+
+        struct Action
+        {
+            ActionKind kind = ActionKind::ERROR;
+            bool conflicted = false; // the cell had more than one distinct action
+            std::uint32_t value = 0; // target state for SHIFT, rule for REDUCE/ACCEPT
+        };
+
+        struct RuleInfo
+        {
+            Rule rule;
+            RuleId id;
+            SymbolId left;
+            std::uint32_t length;
+        };
+
+        // Reductions of unit rules that follow a GOTO, and the state they end in.
+        struct UnitChain
+        {
+            SymbolId lookahead;
+            StateId target;
+            std::vector<RuleId> rules;
+        };
+
+    private:
+        friend class Parser;
+
+        std::vector<Symbol> symbols;
+        std::unordered_map<std::string_view, SymbolId> symbolIds;
+        std::uint32_t terminalCount = 0;
+        std::uint32_t nonterminalCount = 0;
+        std::uint32_t stateCount = 0;
+        StateId startState = 0;
+
+        std::vector<RuleInfo> rules;
+        std::vector<Action> actions;           // stateCount x terminalCount
+        std::vector<std::uint32_t> conflictSlots; // parallel to actions, 0 = no conflict
+        std::vector<std::vector<Action>> conflictSets;
+        std::vector<StateId> gotos;            // stateCount x nonterminalCount
+        std::vector<std::uint32_t> chainSlots; // parallel to gotos, 0 = no chains
+        std::vector<std::vector<UnitChain>> unitChains;
+
+    public:
+        std::uint32_t getTerminalCount() const noexcept { return terminalCount; }
+        std::uint32_t getNonterminalCount() const noexcept { return nonterminalCount; }
+        std::uint32_t getStateCount() const noexcept { return stateCount; }
+        std::size_t getRuleCount() const noexcept { return rules.size(); }
+        StateId getStartState() const noexcept { return startState; }
+
+        const Symbol &getSymbol(SymbolId id) const { return symbols[id]; }
+        const RuleInfo &getRule(RuleId id) const { return rules[id]; }
+
+        bool isTerminal(SymbolId id) const noexcept { return id < terminalCount; }
+
+        std::optional<SymbolId> getSymbolId(const Symbol &symbol) const
+        {
+            auto it = symbolIds.find(symbol.getName());
+            if (it == symbolIds.end())
+                return std::nullopt;
+            return it->second;
+        }
+
+        const Action &getAction(StateId state, SymbolId terminal) const
+        {
+            return actions[std::size_t(state) * terminalCount + terminal];
+        }
+
+        // Every action of a cell: the single action, or all of them for a conflicted cell.
+        std::span<const Action> getActions(StateId state, SymbolId terminal) const
+        {
+            auto cell = std::size_t(state) * terminalCount + terminal;
+            if (!actions[cell].conflicted)
+                return {&actions[cell], 1};
+            return conflictSets[conflictSlots[cell] - 1];
+        }
+
+        StateId getGoto(StateId state, SymbolId nonterminal) const
+        {
+            return gotos[std::size_t(state) * nonterminalCount + (nonterminal - terminalCount)];
+        }
+
+        const UnitChain *getUnitChain(StateId state, SymbolId nonterminal, SymbolId lookahead) const
+        {
+            auto slot = chainSlots[std::size_t(state) * nonterminalCount + (nonterminal - terminalCount)];
+            if (slot == 0)
+                return nullptr;
+
+            for (const auto &chain : unitChains[slot - 1])
+            {
+                if (chain.lookahead == lookahead)
+                    return &chain;
+            }
+            return nullptr;
+        }
+    };
+
+} // namespace IStudio::Compiler
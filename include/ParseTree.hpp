@@ -1,13 +1,247 @@
 #pragma once
 
-namespace IStudio::Compiler{
+#include "Types_Compiler.hpp"
+#include "ParseTable.hpp"
+#include "Exception.hpp"
+#include "token.hpp"
 
-class ParseTree{
+namespace IStudio::Compiler
+{
 
-    using DataType = std::variant<Token,>
+    // Parse tree stored as parallel arrays, one entry per node, in post-order as the LR
+    // reductions produce it: children always precede their parent and the root is last.
+    // Children of a node are reached through firstChild / nextSibling.
+    class ParseTree
+    {
+    public:
+        using NodeId = std::uint32_t;
+        using Kind = ParseTable::SymbolId;
 
+        static constexpr NodeId NO_NODE = std::numeric_limits<NodeId>::max();
 
-};
+    private:
+        static constexpr std::array<char, 4> MAGIC{'I', 'S', 'P', 'T'};
+        static constexpr std::uint32_t VERSION = 1;
 
+        std::vector<Kind> kinds;
+        std::vector<NodeId> firstChildren;
+        std::vector<NodeId> nextSiblings;
+        std::vector<std::uint32_t> childCounts;
+        std::vector<std::uint32_t> tokenBegins; // token span [begin, end) covered by the node
+        std::vector<std::uint32_t> tokenEnds;
+        std::uint32_t leafCount = 0;
 
-}
\ No newline at end of file
+        template <typename T>
+        static void writeArray(std::ostream &out, const std::vector<T> &array)
+        {
+            out.write(reinterpret_cast<const char *>(array.data()), std::streamsize(array.size() * sizeof(T)));
+        }
+
+        static constexpr std::size_t NODE_BYTES = sizeof(Kind) + 2 * sizeof(NodeId) + 3 * sizeof(std::uint32_t);
+        static constexpr std::size_t READ_CHUNK = 64 * 1024; // elements
+
+        // Grows `array` as data arrives, so a bad count fails at the end of the stream
+        // rather than in one huge allocation.
+        template <typename T>
+        static void readArray(std::istream &in, std::vector<T> &array, std::size_t count)
+        {
+            array.clear();
+            while (array.size() < count)
+            {
+                auto done = array.size();
+                auto chunk = std::min(count - done, READ_CHUNK);
+                array.resize(done + chunk);
+                if (!in.read(reinterpret_cast<char *>(array.data() + done), std::streamsize(chunk * sizeof(T))))
+                    throw IStudio::Exception::InvalidFileFormatException{"Truncated parse tree file."};
+            }
+        }
+
+        // Bytes left in `in`, if it can seek.
+        static std::optional<std::uint64_t> remaining(std::istream &in)
+        {
+            auto here = in.tellg();
+            if (here == std::istream::pos_type(-1) || !in.seekg(0, std::ios::end))
+            {
+                in.clear();
+                return std::nullopt;
+            }
+            auto end = in.tellg();
+            in.seekg(here);
+            if (end == std::istream::pos_type(-1) || !in)
+                return std::nullopt;
+            return std::uint64_t(end - here);
+        }
+
+        // Links and token spans must describe a post-order tree: children before their
+        // parent, sibling lists that end, every node the child of at most one parent.
+        void validate() const
+        {
+            auto corrupt = []
+            { throw IStudio::Exception::InvalidFileFormatException{"Corrupt parse tree file."}; };
+
+            std::uint64_t children = 0;
+            for (std::size_t node = 0; node < kinds.size(); ++node)
+            {
+                children += childCounts[node];
+                if (tokenBegins[node] > tokenEnds[node] || tokenEnds[node] > leafCount)
+                    corrupt();
+                if (nextSiblings[node] != NO_NODE && (nextSiblings[node] <= node || nextSiblings[node] >= kinds.size()))
+                    corrupt();
+            }
+            if (children >= std::max<std::size_t>(kinds.size(), 1))
+                corrupt();
+
+            for (std::size_t node = 0; node < kinds.size(); ++node)
+            {
+                std::uint32_t count = 0;
+                for (auto child = firstChildren[node]; child != NO_NODE; child = nextSiblings[child])
+                {
+                    if (child >= node || ++count > childCounts[node])
+                        corrupt();
+                }
+                if (count != childCounts[node])
+                    corrupt();
+            }
+        }
+
+    public:
+        std::size_t size() const noexcept { return kinds.size(); }
+        bool empty() const noexcept { return kinds.empty(); }
+        NodeId root() const noexcept { return empty() ? NO_NODE : NodeId(kinds.size() - 1); }
+
+        Kind kind(NodeId node) const { return kinds[node]; }
+        NodeId firstChild(NodeId node) const { return firstChildren[node]; }
+        NodeId nextSibling(NodeId node) const { return nextSiblings[node]; }
+        std::uint32_t childCount(NodeId node) const { return childCounts[node]; }
+        std::uint32_t tokenBegin(NodeId node) const { return tokenBegins[node]; }
+        std::uint32_t tokenEnd(NodeId node) const { return tokenEnds[node]; }
+        bool isLeaf(NodeId node) const { return firstChildren[node] == NO_NODE && tokenEnds[node] - tokenBegins[node] == 1; }
+
+        // Whole columns, for linear scans over every node.
+        std::span<const Kind> getKinds() const noexcept { return kinds; }
+        std::span<const NodeId> getFirstChildren() const noexcept { return firstChildren; }
+        std::span<const std::uint32_t> getChildCounts() const noexcept { return childCounts; }
+        std::span<const std::uint32_t> getTokenBegins() const noexcept { return tokenBegins; }
+        std::span<const std::uint32_t> getTokenEnds() const noexcept { return tokenEnds; }
+
+        void forEachChild(NodeId node, auto &&f) const
+        {
+            for (auto child = firstChildren[node]; child != NO_NODE; child = nextSiblings[child])
+                f(child);
+        }
+
+        void reserve(std::size_t nodes)
+        {
+            kinds.reserve(nodes);
+            firstChildren.reserve(nodes);
+            nextSiblings.reserve(nodes);
+            childCounts.reserve(nodes);
+            tokenBegins.reserve(nodes);
+            tokenEnds.reserve(nodes);
+        }
+
+        void clear() noexcept
+        {
+            kinds.clear();
+            firstChildren.clear();
+            nextSiblings.clear();
+            childCounts.clear();
+            tokenBegins.clear();
+            tokenEnds.clear();
+            leafCount = 0;
+        }
+
+        // Leaves must be added in token order.
+        NodeId addLeaf(Kind kind)
+        {
+            kinds.push_back(kind);
+            firstChildren.push_back(NO_NODE);
+            nextSiblings.push_back(NO_NODE);
+            childCounts.push_back(0);
+            tokenBegins.push_back(leafCount);
+            tokenEnds.push_back(++leafCount);
+            return NodeId(kinds.size() - 1);
+        }
+
+        NodeId addNode(Kind kind, std::span<const NodeId> children)
+        {
+            for (std::size_t i = 0; i + 1 < children.size(); ++i)
+                nextSiblings[children[i]] = children[i + 1];
+
+            kinds.push_back(kind);
+            firstChildren.push_back(children.empty() ? NO_NODE : children.front());
+            nextSiblings.push_back(NO_NODE);
+            childCounts.push_back(std::uint32_t(children.size()));
+            tokenBegins.push_back(children.empty() ? leafCount : tokenBegins[children.front()]);
+            tokenEnds.push_back(children.empty() ? leafCount : tokenEnds[children.back()]);
+            return NodeId(kinds.size() - 1);
+        }
+
+        // Raw dump of the columns in host byte order; read() expects the same layout.
+        void write(std::ostream &out) const
+        {
+            std::uint64_t count = kinds.size();
+            out.write(MAGIC.data(), MAGIC.size());
+            out.write(reinterpret_cast<const char *>(&VERSION), sizeof(VERSION));
+            out.write(reinterpret_cast<const char *>(&leafCount), sizeof(leafCount));
+            out.write(reinterpret_cast<const char *>(&count), sizeof(count));
+            writeArray(out, kinds);
+            writeArray(out, firstChildren);
+            writeArray(out, nextSiblings);
+            writeArray(out, childCounts);
+            writeArray(out, tokenBegins);
+            writeArray(out, tokenEnds);
+        }
+
+        static ParseTree read(std::istream &in)
+        {
+            std::array<char, 4> magic{};
+            std::uint32_t version = 0;
+            std::uint64_t count = 0;
+            ParseTree tree;
+
+            in.read(magic.data(), magic.size());
+            in.read(reinterpret_cast<char *>(&version), sizeof(version));
+            in.read(reinterpret_cast<char *>(&tree.leafCount), sizeof(tree.leafCount));
+            in.read(reinterpret_cast<char *>(&count), sizeof(count));
+            if (!in || magic != MAGIC || version != VERSION)
+                throw IStudio::Exception::InvalidFileFormatException{"Not a parse tree file."};
+            auto left = remaining(in);
+            if (count >= NO_NODE || (left && count > *left / NODE_BYTES))
+                throw IStudio::Exception::InvalidFileFormatException{"Truncated parse tree file."};
+
+            readArray(in, tree.kinds, count);
+            readArray(in, tree.firstChildren, count);
+            readArray(in, tree.nextSiblings, count);
+            readArray(in, tree.childCounts, count);
+            readArray(in, tree.tokenBegins, count);
+            readArray(in, tree.tokenEnds, count);
+            tree.validate();
+            return tree;
+        }
+    };
+
+    // ParseDriver builder appending nodes to a ParseTree; values are node indices.
+    class ParseTreeBuilder
+    {
+    private:
+        ParseTree &tree;
+        const ParseTable &table;
+
+    public:
+        using value_type = ParseTree::NodeId;
+
+        ParseTreeBuilder(ParseTree &tree, const ParseTable &table) : tree(tree), table(table) {}
+
+        value_type shift(const Token &token, [[maybe_unused]] std::size_t index)
+        {
+            return tree.addLeaf(table.getSymbolId(token.getTerminal()).value_or(0));
+        }
+
+        value_type reduce(const ParseTable::RuleInfo &rule, std::span<value_type> children)
+        {
+            return tree.addNode(rule.left, children);
+        }
+    };
+
+} // namespace IStudio::Compiler
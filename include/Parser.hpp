@@ -10,6 +10,14 @@
 #include "Lexer.hpp"
 #include "token.hpp"
 #include "ast.hpp"
+#include "ParseTable.hpp"
+#include "ParseDriver.hpp"
+#include "AstArena.hpp"
+#include "ParseTree.hpp"
+#include "SemanticActions.hpp"
+#include "ParseEvents.hpp"
+#include "GLRDriver.hpp"
+#include "Error.hpp"
 #include "Logger.hpp"
 
 namespace IStudio::Compiler
@@ -32,6 +40,12 @@ namespace IStudio::Compiler
         std::map<STATE_TYPE, std::map<Terminal, GOTO_TABLE_VALUE>> gotoTable;
         std::map<STATE_TYPE, std::map<Nonterminal, STATE_TYPE>> actionTable;
 
+        ParseTable table;
+        bool collapseUnitChains = false;
+        std::vector<bool> syncTerminals; // indexed by terminal id
+        std::vector<bool> topLevelSync;  // indexed by terminal id
+        std::vector<std::int8_t> nesting; // +1 opens, -1 closes a nesting pair
+
         void handleTerminal(const STATE_TYPE &state, const Terminal &terminal)
         {
             auto new_state = reduce(GOTO(state, grammer, terminal));
@@ -112,6 +126,220 @@ namespace IStudio::Compiler
             return std::nullopt;
         }
 
+        ParseTable::SymbolId symbolId(const Symbol &symbol) const
+        {
+            auto id = table.getSymbolId(symbol);
+            if (!id)
+                throw IStudio::Exception::CompilerError{"Unknown symbol in grammar: " + std::string{symbol.getName()}};
+            return *id;
+        }
+
+        // Numbers states, symbols and rules and flattens the map based tables into ParseTable.
+        void compileTables(const STATE_TYPE &initial)
+        {
+            auto terminals = grammer.getTerminals();
+            terminals.insert(DOLLAR);
+            const auto &nonterminals = grammer.getNonterminals();
+
+            for (const auto &terminal : terminals)
+            {
+                table.symbolIds.emplace(terminal.getName(), ParseTable::SymbolId(table.symbols.size()));
+                table.symbols.push_back(terminal);
+            }
+            for (const auto &nonterminal : nonterminals)
+            {
+                table.symbolIds.emplace(nonterminal.getName(), ParseTable::SymbolId(table.symbols.size()));
+                table.symbols.push_back(nonterminal);
+            }
+            table.terminalCount = std::uint32_t(terminals.size());
+            table.nonterminalCount = std::uint32_t(nonterminals.size());
+
+            std::map<STATE_TYPE, ParseTable::StateId> stateIds;
+            for (const auto &state : states)
+                stateIds.emplace(state, ParseTable::StateId(stateIds.size()));
+            table.stateCount = std::uint32_t(states.size());
+            table.startState = stateIds.at(initial);
+
+            for (const auto &rule : grammer.getRules())
+                table.rules.push_back({rule, ParseTable::RuleId(table.rules.size()), symbolId(rule.getLeft()), std::uint32_t(rule.getRight().size())});
+
+            auto ruleId = [&](const Rule &rule)
+            {
+                auto it = std::find_if(table.rules.begin(), table.rules.end(), [&](const auto &info)
+                                       { return info.rule == rule; });
+                return ParseTable::RuleId(std::distance(table.rules.begin(), it));
+            };
+
+            table.actions.assign(std::size_t(table.stateCount) * table.terminalCount, {});
+            table.conflictSlots.assign(table.actions.size(), 0);
+            table.gotos.assign(std::size_t(table.stateCount) * table.nonterminalCount, ParseTable::NO_STATE);
+            table.chainSlots.assign(table.gotos.size(), 0);
+
+            std::size_t conflicts = 0;
+            for (const auto &[state, cells] : gotoTable)
+            {
+                auto from = stateIds.at(state);
+                for (const auto &[terminal, values] : cells)
+                {
+                    auto cell = std::size_t(from) * table.terminalCount + symbolId(terminal);
+                    std::vector<ParseTable::Action> distinct;
+                    for (const auto &[command, value] : values)
+                    {
+                        ParseTable::Action candidate;
+                        if (command == GOTO_COMMAND::SHIFT)
+                            candidate = {ParseTable::ActionKind::SHIFT, false, stateIds.at(std::get<STATE_TYPE>(value))};
+                        else if (command == GOTO_COMMAND::REDUCE)
+                            candidate = {ParseTable::ActionKind::REDUCE, false, ruleId(std::get<Rule>(value))};
+                        else
+                            candidate = {ParseTable::ActionKind::ACCEPT, false, ruleId(std::get<Rule>(value))};
+
+                        if (std::none_of(distinct.begin(), distinct.end(), [&](const auto &a)
+                                         { return a.kind == candidate.kind && a.value == candidate.value; }))
+                            distinct.push_back(candidate);
+                    }
+
+                    // The first action recorded for a cell wins, as before; a conflicted cell also
+                    // keeps all of them for the GLR driver.
+                    if (distinct.empty())
+                        continue;
+                    table.actions[cell] = distinct.front();
+                    if (distinct.size() > 1)
+                    {
+                        for (auto &action : distinct)
+                            action.conflicted = true;
+                        table.actions[cell].conflicted = true;
+                        table.conflictSets.push_back(std::move(distinct));
+                        table.conflictSlots[cell] = std::uint32_t(table.conflictSets.size());
+                        ++conflicts;
+                    }
+                }
+            }
+            if (conflicts > 0)
+                logger(IStudio::Log::LogLevel::INFO, 1) << "Conflicted table cells: " << conflicts;
+
+            for (const auto &[state, transitions] : actionTable)
+            {
+                auto from = stateIds.at(state);
+                for (const auto &[nonterminal, target] : transitions)
+                    table.gotos[std::size_t(from) * table.nonterminalCount + (symbolId(nonterminal) - table.terminalCount)] = stateIds.at(target);
+            }
+        }
+
+        Error::Diagnostic syntaxError(const Token &token, const std::vector<ParseTable::SymbolId> &expected) const
+        {
+            auto name = [](const Symbol &symbol)
+            {
+                return symbol == DOLLAR ? std::string{"end of input"} : std::string{symbol.getName()};
+            };
+
+            std::string message = "Unexpected " + name(token.getTerminal());
+            for (std::size_t i = 0; i < expected.size(); ++i)
+                message += (i == 0 ? ", expected " : ", ") + name(table.getSymbol(expected[i]));
+            return {Error::Severity::ERROR, std::move(message), token.getOffset(), 0, 0};
+        }
+
+        void compileSegmentation()
+        {
+            topLevelSync.assign(table.getTerminalCount(), false);
+            nesting.assign(table.getTerminalCount(), 0);
+            for (const auto &terminal : grammer.getTopLevelSync())
+                topLevelSync[symbolId(terminal)] = true;
+            for (const auto &[open, close] : grammer.getNestingPairs())
+            {
+                nesting[symbolId(open)] = 1;
+                nesting[symbolId(close)] = -1;
+            }
+        }
+
+        // Token indices where top-level segments start, ending with the index of DOLLAR. The
+        // first segment is a single declaration, since it is parsed before the others start;
+        // the rest are grouped into about four segments per worker.
+        std::vector<std::size_t> segment(const std::vector<Token> &tokens, std::size_t workers) const
+        {
+            std::vector<std::size_t> bounds{0};
+            if (tokens.empty())
+                return bounds;
+
+            std::size_t end = tokens.size() - 1;
+            std::size_t target = std::max<std::size_t>(64, end / (std::max<std::size_t>(workers, 1) * 4));
+            int depth = 0;
+            for (std::size_t i = 0; i < end; ++i)
+            {
+                auto id = table.getSymbolId(tokens[i].getTerminal());
+                if (!id || !table.isTerminal(*id))
+                    continue;
+                depth = std::max(0, depth + nesting[*id]);
+                if (depth == 0 && topLevelSync[*id] && i + 1 < end &&
+                    (bounds.size() == 1 || i + 1 - bounds.back() >= target))
+                    bounds.push_back(i + 1);
+            }
+            bounds.push_back(end);
+            return bounds;
+        }
+
+        // The unit rule reduced in `state` on `lookahead`, if that is the only action there.
+        std::optional<ParseTable::RuleId> getUnitReduce(ParseTable::StateId state, ParseTable::SymbolId lookahead) const
+        {
+            const auto &action = table.getAction(state, lookahead);
+            if (action.kind != ParseTable::ActionKind::REDUCE || action.conflicted)
+                return std::nullopt;
+
+            const auto &rule = table.getRule(action.value);
+            if (rule.length != 1 || !rule.rule.getRight().front().isNonterminal())
+                return std::nullopt;
+            return action.value;
+        }
+
+        // Combined reduce-and-goto for chains of unit rules (A <= B, B nonterminal), keyed by
+        // the exposed state, the nonterminal just reduced and the lookahead.
+        void buildUnitChains()
+        {
+            std::size_t chains = 0;
+            for (ParseTable::StateId exposed = 0; exposed < table.stateCount; ++exposed)
+            {
+                for (auto nonterminal = table.terminalCount; nonterminal < table.symbols.size(); ++nonterminal)
+                {
+                    auto reached = table.getGoto(exposed, nonterminal);
+                    if (reached == ParseTable::NO_STATE)
+                        continue;
+
+                    std::vector<ParseTable::UnitChain> cell;
+                    for (ParseTable::SymbolId lookahead = 0; lookahead < table.terminalCount; ++lookahead)
+                    {
+                        ParseTable::UnitChain chain{lookahead, reached, {}};
+                        std::vector<ParseTable::SymbolId> visited{nonterminal};
+
+                        while (auto unit = getUnitReduce(chain.target, lookahead))
+                        {
+                            auto left = table.getRule(*unit).left;
+                            if (std::find(visited.begin(), visited.end(), left) != visited.end())
+                                break;
+                            visited.push_back(left);
+
+                            auto next = table.getGoto(exposed, left);
+                            if (next == ParseTable::NO_STATE)
+                                break;
+
+                            chain.rules.push_back(*unit);
+                            chain.target = next;
+                        }
+
+                        if (!chain.rules.empty())
+                            cell.push_back(std::move(chain));
+                    }
+
+                    if (!cell.empty())
+                    {
+                        chains += cell.size();
+                        table.unitChains.push_back(std::move(cell));
+                        table.chainSlots[std::size_t(exposed) * table.nonterminalCount + (nonterminal - table.terminalCount)] = std::uint32_t(table.unitChains.size());
+                    }
+                }
+            }
+
+            logger(IStudio::Log::LogLevel::INFO, 1) << "Unit rule chains precomputed: " << chains;
+        }
+
     public:
         explicit Parser(const Grammar &grammer, IStudio::Log::Logger logger = IStudio::Log::Logger("parser.log", IStudio::Log::LogLevel::DEBUG))
             : grammer(grammer), logger(std::move(logger))
@@ -146,114 +374,246 @@ namespace IStudio::Compiler
                 new_size = states.size();
             } while (old_size != new_size);
 
+            compileTables(I0);
+            buildUnitChains();
+            compileSegmentation();
+
             logger(IStudio::Log::LogLevel::INFO, 1) << "Parser initialized with " << states.size() << " states.";
         }
 
-        std::shared_ptr<ASTNode> parse(auto tokens) const
+        template <ParseBuilder Builder>
+        typename Builder::value_type parse(auto &&tokens, Builder &builder) const
         {
-            std::stack<STATE_TYPE> stateStack;
-            std::stack<Symbol> symbolStack;
-            std::stack<std::shared_ptr<ASTNode>> astStack;
-
-            stateStack.push(*states.begin());
+            auto driver = makeDriver(builder);
 
             for (const Token &currentToken : tokens)
             {
-            re_iterate:
-                const Terminal &terminal = currentToken.getTerminal();
+                if (driver.feed(currentToken) == ParseDriver<Builder>::Status::ACCEPTED)
+                    break;
+            }
+
+            return driver.finish();
+        }
 
-                logger(IStudio::Log::LogLevel::DEBUG, 2) << "Parsing token: " << terminal;
+        // Errors within this many shifted tokens of the last one are not reported again.
+        static constexpr std::size_t RECOVERY_TOKENS = 3;
+
+        // Parse that reports syntax errors as diagnostics instead of throwing. After an error
+        // the parser discards tokens up to a sync terminal (or DOLLAR), pops states until that
+        // terminal has an action and carries on; if none has, it drops the terminal and
+        // restarts from the start state. One pass therefore reports every error, and the
+        // result holds the value only if no error was found. Syntax errors carry the token's
+        // offset only; SourceMap::locate() gives their lines and columns.
+        template <ParseBuilder Builder>
+        Error::Result<typename Builder::value_type> tryParse(auto &&tokens, Builder &builder, Error::Diagnostics &diagnostics) const
+        {
+            auto driver = makeDriver(builder);
+            auto dollar = symbolId(DOLLAR);
+            std::size_t quiet = 0;
+            bool skipping = false;
 
-                auto currentState = stateStack.top();
-                auto actionIt = gotoTable.find(currentState);
+            for (const Token &currentToken : tokens)
+            {
+                auto id = table.getSymbolId(currentToken.getTerminal());
+                bool sync = id && (*id == dollar || (*id < syncTerminals.size() && syncTerminals[*id]));
+                if (skipping && !sync)
+                    continue;
+                if (skipping)
+                {
+                    skipping = false;
+                    driver.recoverTo(*id);
+                }
 
-                if (actionIt != gotoTable.end())
+                auto status = driver.tryFeed(currentToken);
+                if (!status)
                 {
-                    auto &terminalActions = actionIt->second;
-                    auto terminalIt = terminalActions.find(terminal);
+                    if (quiet == 0)
+                        diagnostics.push_back(syntaxError(currentToken, driver.expectedTerminals()));
+                    quiet = RECOVERY_TOKENS + 1;
 
-                    if (terminalIt != terminalActions.end())
+                    if (!sync)
                     {
-                        const auto &actions = terminalIt->second;
-                        for (const auto &[command, value] : actions)
-                        {
-                            if (command == GOTO_COMMAND::SHIFT)
-                            {
-                                logger(IStudio::Log::LogLevel::DEBUG, 2) << "SHIFT";
-                                stateStack.push(std::get<STATE_TYPE>(value));
-                                symbolStack.push(terminal);
-                                astStack.push(std::make_shared<ASTNode>(terminal));
-                                break;
-                            }
-                            else if (command == GOTO_COMMAND::REDUCE)
-                            {
-                                const Rule &rule = std::get<Rule>(value);
-                                logger(IStudio::Log::LogLevel::DEBUG, 2) << "REDUCE: " << rule;
- 
-                                auto newNode = std::make_shared<ASTNode>(rule.getLeft());
-                                std::vector<std::shared_ptr<ASTNode>> children;
-
-                                if (astStack.size() < rule.getRight().size())
-                                {
-                                    logger(IStudio::Log::LogLevel::ERROR, 1) << "Not enough AST nodes to reduce.";
-                                    throw IStudio::Exception::ParserException{"Not enough AST nodes to reduce."};
-                                }
-
-                                for (std::size_t i = 0; i < rule.getRight().size(); ++i)
-                                {
-                                    stateStack.pop();
-                                    symbolStack.pop();
-
-
-                                    auto child = astStack.top();
-                                    astStack.pop();
-                                    children.push_back(child);
-                                }
-
-                                std::reverse(children.begin(), children.end());
-                                for (const auto &child : children)
-                                    newNode->addChild(child);
-                                astStack.push(newNode);
-
-                                auto state_temp = stateStack.top();
-                                auto nextState = actionTable.at(state_temp).find(rule.getLeft());
-                                if (nextState != actionTable.at(state_temp).end())
-                                {
-                                    stateStack.push(nextState->second);
-                                    symbolStack.push(rule.getLeft());
-                                }
-                                else
-                                {
-                                    logger(IStudio::Log::LogLevel::ERROR, 1) << "No valid state transition after reduce.";
-                                    throw IStudio::Exception::ParserException{"No valid state transition after reduce."};
-                                }
-                                goto re_iterate;
-                            }
-                            else if (command == GOTO_COMMAND::ACCEPT)
-                            {
-                                logger(IStudio::Log::LogLevel::INFO, 1) << "ACCEPT";
-                                return astStack.top(); // root of AST;
-                            }
-                        }
+                        skipping = true;
+                        continue;
                     }
-                    else
+                    if (driver.recoverTo(*id))
+                        status = driver.tryFeed(currentToken);
+                    if (!status)
                     {
-                        logger(IStudio::Log::LogLevel::ERROR, 1) << "No valid action for terminal: " << terminal;
-                        throw IStudio::Exception::ParserException{
-                            "No valid action for terminal: " + std::string{terminal.getName()}};
+                        if (*id == dollar)
+                            break;
+                        continue;
                     }
                 }
+
+                if (quiet > 0)
+                    --quiet;
+                if (*status == ParseDriver<Builder>::Status::ACCEPTED)
+                    break;
+            }
+
+            if (!driver.accepted() && diagnostics.empty())
+                diagnostics.push_back({Error::Severity::ERROR, "Input not fully parsed.", 0, 0, 0});
+            if (std::any_of(diagnostics.begin(), diagnostics.end(), [](const Error::Diagnostic &d)
+                            { return d.severity == Error::Severity::ERROR; }))
+                return std::unexpected(std::move(diagnostics));
+            return driver.result();
+        }
+
+        Error::Result<std::shared_ptr<ASTNode>> tryParse(auto &&tokens) const
+        {
+            ASTBuilder builder;
+            Error::Diagnostics diagnostics;
+            return tryParse(tokens, builder, diagnostics);
+        }
+
+        // Terminals tryParse() resynchronizes on, such as statement terminators.
+        void setSyncTerminals(const std::set<Terminal> &terminals)
+        {
+            syncTerminals.assign(table.getTerminalCount(), false);
+            for (const auto &terminal : terminals)
+                syncTerminals[symbolId(terminal)] = true;
+        }
+
+        template <ParseBuilder Builder>
+        ParseDriver<Builder> makeDriver(Builder &builder) const
+        {
+            return ParseDriver<Builder>{table, builder, logger, collapseUnitChains};
+        }
+
+        std::shared_ptr<ASTNode> parse(auto &&tokens) const
+        {
+            ASTBuilder builder;
+            return parse(tokens, builder);
+        }
+
+        // Builds the tree inside `arena`; it stays valid until the arena is reset or destroyed.
+        const ArenaNode *parse(auto &&tokens, AstArena &arena) const
+        {
+            ArenaBuilder builder{arena, table};
+            return parse(tokens, builder);
+        }
+
+        // Appends the nodes to `tree` in post-order and returns the root index.
+        ParseTree::NodeId parse(auto &&tokens, ParseTree &tree) const
+        {
+            ParseTreeBuilder builder{tree, table};
+            return parse(tokens, builder);
+        }
+
+        // Evaluates `actions` while parsing instead of building a tree. Unit-chain
+        // collapsing skips the callbacks of the collapsed unit rules.
+        template <typename Value>
+        Value parse(auto &&tokens, const SemanticActions<Value> &actions) const
+        {
+            SemanticActionBuilder<Value> builder{actions, table};
+            return parse(tokens, builder);
+        }
+
+        // Validation-only parse: reports shift/reduce events to `sink` and builds no tree.
+        void parse(auto &&tokens, ParseEventSink &sink) const
+        {
+            ParseEventBuilder builder{sink};
+            parse(tokens, builder);
+            sink.accept();
+        }
+
+        // GLR parse: follows every action of conflicted cells and packs all derivations into
+        // `forest`. Conflict-free stretches of the input stay on the deterministic path.
+        ParseForest::NodeId parse(auto &&tokens, ParseForest &forest) const
+        {
+            GLRDriver driver{table, forest, logger};
+
+            for (const Token &currentToken : tokens)
+            {
+                if (driver.feed(currentToken))
+                    break;
+            }
+
+            return driver.finish();
+        }
+
+        // Parses the top-level declarations of `tokens` (see Grammar::setTopLevelSync) on
+        // `pool`. The first declaration is parsed in order, which gives the LR state the next
+        // one starts from; the other segments are parsed from that state concurrently and
+        // spliced onto the stack in order, each after checking that the real parse reached
+        // the same state. A segment failing the check, or whose parse failed or would pop
+        // below its start state, is parsed again in sequence, so the tree and any error are
+        // those of parse().
+        std::shared_ptr<ASTNode> parseParallel(const std::vector<Token> &tokens,
+                                               Util::ThreadPool &pool = Util::ThreadPool::shared()) const
+        {
+            ASTBuilder builder;
+            auto bounds = segment(tokens, pool.size());
+            if (bounds.size() < 4 || pool.size() < 2)
+                return parse(tokens, builder);
+
+            auto driver = makeDriver(builder);
+            auto feedRange = [&](std::size_t begin, std::size_t end)
+            {
+                for (auto i = begin; i < end; ++i)
+                    driver.feed(tokens[i]);
+            };
+
+            feedRange(bounds[0], bounds[1]);
+            driver.reduceOn(tokens[bounds[1]]);
+            auto entry = driver.currentState();
+
+            using Segment = std::optional<ParseDriver<ASTBuilder>::Snapshot>;
+            std::vector<Segment> segments(bounds.size() - 1);
+            pool.parallelFor(segments.size() - 1, [&](std::size_t index, std::size_t)
+                             {
+                                 auto k = index + 1;
+                                 ASTBuilder local;
+                                 auto speculative = makeDriver(local);
+                                 speculative.resetTo(entry, bounds[k]);
+                                 for (auto i = bounds[k]; i < bounds[k + 1]; ++i)
+                                 {
+                                     if (!speculative.tryFeed(tokens[i]))
+                                         return;
+                                 }
+                                 segments[k] = speculative.release();
+                             });
+
+            std::size_t reparsed = 0;
+            for (std::size_t k = 1; k < segments.size(); ++k)
+            {
+                driver.reduceOn(tokens[bounds[k]]);
+                if (segments[k] && driver.currentState() == entry)
+                    driver.splice(std::move(*segments[k]));
                 else
                 {
-                    logger(IStudio::Log::LogLevel::ERROR, 1) << "No valid state transition.";
-                    throw IStudio::Exception::ParserException{"No valid state transition."};
+                    feedRange(bounds[k], bounds[k + 1]);
+                    ++reparsed;
                 }
             }
+            if (logger.shouldLog(IStudio::Log::LogLevel::DEBUG, 2))
+                logger(IStudio::Log::LogLevel::DEBUG, 2) << "Parallel parse: " << segments.size() << " segments, " << reparsed << " reparsed";
 
-            logger(IStudio::Log::LogLevel::ERROR, 1) << "Input not fully parsed.";
-            throw IStudio::Exception::ParserException{"Input not fully parsed."};
+            feedRange(bounds.back(), tokens.size());
+            return driver.finish();
         }
 
+        // Pipeline stage for `tokens | parser.events(sink)`.
+        struct EventStage
+        {
+            const Parser &parser;
+            ParseEventSink &sink;
+
+            friend void operator|(auto tokens, const EventStage &stage)
+            {
+                stage.parser.parse(tokens, stage.sink);
+            }
+        };
+
+        EventStage events(ParseEventSink &sink) const noexcept { return {*this, sink}; }
+
+        const ParseTable &getTable() const noexcept { return table; }
+
+        // When enabled, nodes for intermediate unit rules are not materialized in the AST.
+        void setCollapseUnitChains(bool collapse) noexcept { collapseUnitChains = collapse; }
+        bool getCollapseUnitChains() const noexcept { return collapseUnitChains; }
+
         friend std::shared_ptr<ASTNode> operator|(auto tokens, const Parser &p)
         {
             return p.parse(tokens);
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "Types_Compiler.hpp"
+#include "Lexer.hpp"
+#include "Parser.hpp"
+
+namespace IStudio::Compiler
+{
+    // Resumable push interface over a Lexer/Parser pair. Tokens or raw chunks are fed as
+    // they arrive; the LR stacks and any partial lexeme persist between calls, so parsing
+    // overlaps with I/O and no whole-document buffer is kept.
+    template <ParseBuilder Builder = ASTBuilder>
+    class ParserSession
+    {
+    private:
+        Builder builder;
+        Lexer::ChunkScanner scanner;
+        ParseDriver<Builder> driver;
+
+    public:
+        ParserSession(const Lexer &lexer, const Parser &parser, Builder b = {})
+            : builder(std::move(b)), scanner(lexer), driver(parser.makeDriver(builder))
+        {
+        }
+
+        // The driver refers to `builder`, so a session stays where it was created.
+        ParserSession(const ParserSession &) = delete;
+        ParserSession &operator=(const ParserSession &) = delete;
+
+        // Returns true once the input has been accepted.
+        bool feed(const Token &token)
+        {
+            return driver.feed(token) == ParseDriver<Builder>::Status::ACCEPTED;
+        }
+
+        void feedChunk(std::string_view bytes)
+        {
+            scanner.feed(bytes, [this](const Token &token) { feed(token); });
+        }
+
+        // Flushes the buffered input, feeds DOLLAR and returns the parse result.
+        typename Builder::value_type finish()
+        {
+            scanner.finish([this](const Token &token) { feed(token); });
+            return driver.finish();
+        }
+
+        bool accepted() const noexcept { return driver.accepted(); }
+        std::size_t buffered() const noexcept { return scanner.buffered(); }
+    };
+
+} // namespace IStudio::Compiler
@@ -0,0 +1,807 @@
+#pragma once
+
+#include "Types_Compiler.hpp"
+#include "Terminal.hpp"
+#include "Grammar.hpp"
+#include "FirstBytes.hpp"
+#include "KeywordTable.hpp"
+#include "Exception.hpp"
+
+namespace IStudio::Compiler
+{
+    // Build-time generator of a direct-coded scanner (re2c style) for a fixed terminal set.
+    // The terminal patterns are compiled into a DFA, and emit() writes it out as C++ with a
+    // label per state, the byte tests of each state inlined in a switch and gotos between
+    // them, so the generated scanner runs without regexes or tables and has no start-up
+    // cost. It finds the lexemes Lexer::next finds: the longest match, ties going to the
+    // first terminal in set order, a keyword over the identifier spelling it, and skip
+    // terminals only where no terminal matches.
+    //
+    // Patterns are matched longest-first, as a DFA does, so an alternation relying on
+    // ECMAScript's ordered choice to prefer a shorter match (`a|ab`) scans differently, and
+    // a pattern with a lazy quantifier ends at its first match (`/\*[\s\S]*?\*/`). Anchors
+    // other than a leading `^`, lookahead and back-references throw InvalidSyntaxException.
+    class ScannerGenerator
+    {
+    public:
+        using Terminals_Type = std::set<Terminal>;
+
+    private:
+        static constexpr std::size_t UNBOUNDED = std::numeric_limits<std::size_t>::max();
+
+        struct Node
+        {
+            enum class Kind
+            {
+                EMPTY,
+                BYTES,
+                CONCAT,
+                ALTERNATE,
+                REPEAT
+            };
+
+            Kind kind = Kind::EMPTY;
+            ByteSet bytes;              // BYTES
+            std::vector<Node> children; // CONCAT, ALTERNATE; REPEAT has one
+            std::size_t minimum = 0, maximum = 0;
+        };
+
+        // ECMAScript pattern to a syntax tree, for the subset a DFA can match.
+        class PatternParser
+        {
+        private:
+            std::string_view pattern;
+            std::size_t position = 0;
+
+            bool atEnd() const { return position >= pattern.length(); }
+            char peek() const { return atEnd() ? '\0' : pattern[position]; }
+
+            [[noreturn]] void unsupported(std::string_view what) const
+            {
+                throw IStudio::Exception::InvalidSyntaxException{
+                    std::format("Scanner generator: {} in pattern \"{}\" is not supported", what, pattern)};
+            }
+
+            static ByteSet matching(int (*predicate)(int))
+            {
+                ByteSet set;
+                for (int c = 0; c < 128; ++c)
+                {
+                    if (predicate(c))
+                        set.set(std::size_t(c));
+                }
+                return set;
+            }
+
+            static int isWord(int c) { return std::isalnum(c) || c == '_'; }
+
+            static std::optional<ByteSet> classEscape(char c)
+            {
+                switch (c)
+                {
+                case 'd': return matching([](int x) { return std::isdigit(x); });
+                case 'w': return matching(isWord);
+                case 's': return matching([](int x) { return std::isspace(x); });
+                case 'D': return ~matching([](int x) { return std::isdigit(x); });
+                case 'W': return ~matching(isWord);
+                case 'S': return ~matching([](int x) { return std::isspace(x); });
+                default: return std::nullopt;
+                }
+            }
+
+            static int hexValue(char c)
+            {
+                if (std::isdigit((unsigned char)c))
+                    return c - '0';
+                if (c >= 'a' && c <= 'f')
+                    return c - 'a' + 10;
+                if (c >= 'A' && c <= 'F')
+                    return c - 'A' + 10;
+                return -1;
+            }
+
+            // Character named by the escape after a backslash, at `position`.
+            unsigned char characterEscape(bool inClass)
+            {
+                char c = pattern[position++];
+                switch (c)
+                {
+                case 'n': return '\n';
+                case 'r': return '\r';
+                case 't': return '\t';
+                case 'f': return '\f';
+                case 'v': return '\v';
+                case '0': return '\0';
+                case 'b':
+                    if (inClass)
+                        return '\b';
+                    unsupported("the word boundary \\b");
+                case 'c':
+                    if (!atEnd() && std::isalpha((unsigned char)peek()))
+                        return (unsigned char)(pattern[position++] % 32);
+                    break;
+                case 'x':
+                    if (position + 1 < pattern.length() && hexValue(pattern[position]) >= 0 && hexValue(pattern[position + 1]) >= 0)
+                    {
+                        auto value = hexValue(pattern[position]) * 16 + hexValue(pattern[position + 1]);
+                        position += 2;
+                        return (unsigned char)value;
+                    }
+                    break;
+                default:
+                    if (std::isdigit((unsigned char)c))
+                        unsupported("a back-reference");
+                    if (!std::isalnum((unsigned char)c))
+                        return (unsigned char)c;
+                    break;
+                }
+                unsupported(std::format("the escape \\{}", c));
+            }
+
+            ByteSet bracket()
+            {
+                ++position; // [
+                bool negated = peek() == '^';
+                if (negated)
+                    ++position;
+
+                ByteSet set;
+                while (!atEnd() && peek() != ']')
+                {
+                    unsigned char low;
+                    if (peek() == '\\' && position + 1 < pattern.length())
+                    {
+                        ++position;
+                        if (auto escape = classEscape(peek()))
+                        {
+                            ++position;
+                            set |= *escape;
+                            continue;
+                        }
+                        low = characterEscape(true);
+                    }
+                    else
+                        low = (unsigned char)pattern[position++];
+
+                    unsigned char high = low;
+                    if (peek() == '-' && position + 1 < pattern.length() && pattern[position + 1] != ']')
+                    {
+                        ++position;
+                        if (peek() == '\\')
+                        {
+                            ++position;
+                            high = characterEscape(true);
+                        }
+                        else
+                            high = (unsigned char)pattern[position++];
+                    }
+                    for (unsigned c = low; c <= high; ++c)
+                        set.set(c);
+                }
+                if (atEnd())
+                    unsupported("an unterminated class");
+                ++position; // ]
+                return negated ? ~set : set;
+            }
+
+            static Node bytes(ByteSet set) { return Node{Node::Kind::BYTES, set, {}, 0, 0}; }
+
+            Node atom()
+            {
+                char c = peek();
+                switch (c)
+                {
+                case '(':
+                {
+                    ++position;
+                    if (peek() == '?')
+                    {
+                        if (position + 1 < pattern.length() && pattern[position + 1] == ':')
+                            position += 2;
+                        else
+                            unsupported("lookahead");
+                    }
+                    auto inner = alternation();
+                    if (peek() != ')')
+                        unsupported("an unbalanced group");
+                    ++position;
+                    return inner;
+                }
+                case '[':
+                    return bytes(bracket());
+                case '.':
+                {
+                    ByteSet set;
+                    set.set();
+                    set.reset('\n');
+                    set.reset('\r');
+                    ++position;
+                    return bytes(set);
+                }
+                case '^':
+                case '$':
+                    unsupported("an anchor");
+                case '\\':
+                {
+                    ++position;
+                    if (atEnd())
+                        unsupported("a trailing backslash");
+                    if (peek() == 'B')
+                        unsupported("the word boundary \\B");
+                    if (auto escape = classEscape(peek()))
+                    {
+                        ++position;
+                        return bytes(*escape);
+                    }
+                    ByteSet set;
+                    set.set(characterEscape(false));
+                    return bytes(set);
+                }
+                default:
+                {
+                    ++position;
+                    ByteSet set;
+                    set.set((unsigned char)c);
+                    return bytes(set);
+                }
+                }
+            }
+
+            // `{m}`, `{m,}` or `{m,n}` at `position`; a brace starting anything else is a
+            // literal, as in FirstBytes.
+            bool bounds(std::size_t &minimum, std::size_t &maximum)
+            {
+                auto close = pattern.find('}', position);
+                if (close == std::string_view::npos)
+                    return false;
+                auto text = pattern.substr(position + 1, close - position - 1);
+                auto comma = text.find(',');
+                auto number = [](std::string_view digits, std::size_t &value)
+                {
+                    auto [end, error] = std::from_chars(digits.data(), digits.data() + digits.length(), value);
+                    return error == std::errc{} && end == digits.data() + digits.length();
+                };
+                if (!number(text.substr(0, comma), minimum))
+                    return false;
+                if (comma == std::string_view::npos)
+                    maximum = minimum;
+                else if (comma + 1 == text.length())
+                    maximum = UNBOUNDED;
+                else if (!number(text.substr(comma + 1), maximum) || maximum < minimum)
+                    return false;
+                position = close + 1;
+                return true;
+            }
+
+            Node quantified(Node node)
+            {
+                while (true)
+                {
+                    std::size_t minimum = 0, maximum = UNBOUNDED;
+                    char c = peek();
+                    if (c == '*')
+                        ++position;
+                    else if (c == '+')
+                    {
+                        minimum = 1;
+                        ++position;
+                    }
+                    else if (c == '?')
+                    {
+                        maximum = 1;
+                        ++position;
+                    }
+                    else if (c != '{' || !bounds(minimum, maximum))
+                        return node;
+
+                    if (peek() == '?')
+                    {
+                        lazy = true;
+                        ++position;
+                    }
+                    Node repeat{Node::Kind::REPEAT, {}, {}, minimum, maximum};
+                    repeat.children.push_back(std::move(node));
+                    node = std::move(repeat);
+                }
+            }
+
+            Node sequence()
+            {
+                Node result{Node::Kind::CONCAT, {}, {}, 0, 0};
+                while (!atEnd() && peek() != '|' && peek() != ')')
+                {
+                    if (peek() == '{')
+                    {
+                        // a brace that is not a quantifier is a literal
+                        ++position;
+                        result.children.push_back(quantified(bytes(ByteSet{}.set('{'))));
+                        continue;
+                    }
+                    result.children.push_back(quantified(atom()));
+                }
+                return result;
+            }
+
+            Node alternation()
+            {
+                Node result{Node::Kind::ALTERNATE, {}, {}, 0, 0};
+                result.children.push_back(sequence());
+                while (peek() == '|')
+                {
+                    ++position;
+                    result.children.push_back(sequence());
+                }
+                return result;
+            }
+
+            explicit PatternParser(std::string_view pattern) : pattern{pattern} {}
+
+        public:
+            bool lazy = false;
+
+            static Node parse(std::string_view pattern, bool &lazy)
+            {
+                PatternParser parser{pattern};
+                if (parser.peek() == '^')
+                    ++parser.position; // scans are anchored anyway
+                auto tree = parser.alternation();
+                if (!parser.atEnd())
+                    parser.unsupported("an unbalanced group");
+                lazy = parser.lazy;
+                return tree;
+            }
+        };
+
+        struct NfaState
+        {
+            ByteSet on;
+            std::uint32_t target = 0; // taken on a byte in `on`
+            std::vector<std::uint32_t> epsilon;
+            std::uint32_t owner = 0; // terminal index
+            bool accepting = false;
+        };
+
+        struct DfaState
+        {
+            std::array<std::int32_t, 256> next;
+            std::int32_t accepts = -1; // terminal index
+            bool halts = false;        // no transitions: a scan stops here without reading on
+        };
+
+        // The DFA of one terminal list, in the order the generated scanner reports them.
+        struct Automaton
+        {
+            std::vector<Terminal> terminals;
+            std::vector<DfaState> states;
+        };
+
+        Automaton scanning;
+        Automaton skipping;
+
+        class NfaBuilder
+        {
+        public:
+            std::vector<NfaState> states;
+
+            std::uint32_t add(std::uint32_t owner)
+            {
+                states.push_back(NfaState{{}, 0, {}, owner, false});
+                return std::uint32_t(states.size() - 1);
+            }
+
+            // Fragment for `node`: start and end state.
+            std::pair<std::uint32_t, std::uint32_t> build(const Node &node, std::uint32_t owner)
+            {
+                auto start = add(owner);
+                auto end = start;
+                switch (node.kind)
+                {
+                case Node::Kind::EMPTY:
+                    break;
+                case Node::Kind::BYTES:
+                    end = add(owner);
+                    states[start].on = node.bytes;
+                    states[start].target = end;
+                    break;
+                case Node::Kind::CONCAT:
+                    for (const auto &child : node.children)
+                    {
+                        auto [first, last] = build(child, owner);
+                        states[end].epsilon.push_back(first);
+                        end = last;
+                    }
+                    break;
+                case Node::Kind::ALTERNATE:
+                    end = add(owner);
+                    for (const auto &child : node.children)
+                    {
+                        auto [first, last] = build(child, owner);
+                        states[start].epsilon.push_back(first);
+                        states[last].epsilon.push_back(end);
+                    }
+                    break;
+                case Node::Kind::REPEAT:
+                {
+                    const auto &child = node.children.front();
+                    for (std::size_t i = 0; i < node.minimum; ++i)
+                    {
+                        auto [first, last] = build(child, owner);
+                        states[end].epsilon.push_back(first);
+                        end = last;
+                    }
+                    if (node.maximum == UNBOUNDED)
+                    {
+                        auto [first, last] = build(child, owner);
+                        auto exit = add(owner);
+                        states[end].epsilon.push_back(first);
+                        states[end].epsilon.push_back(exit);
+                        states[last].epsilon.push_back(first);
+                        states[last].epsilon.push_back(exit);
+                        end = exit;
+                        break;
+                    }
+                    auto exit = add(owner);
+                    for (std::size_t i = node.minimum; i < node.maximum; ++i)
+                    {
+                        auto [first, last] = build(child, owner);
+                        states[end].epsilon.push_back(first);
+                        states[end].epsilon.push_back(exit);
+                        end = last;
+                    }
+                    states[end].epsilon.push_back(exit);
+                    end = exit;
+                    break;
+                }
+                }
+                return {start, end};
+            }
+
+            void closure(std::vector<std::uint32_t> &set) const
+            {
+                std::vector<bool> seen(states.size());
+                for (auto state : set)
+                    seen[state] = true;
+                for (std::size_t i = 0; i < set.size(); ++i)
+                {
+                    for (auto next : states[set[i]].epsilon)
+                    {
+                        if (!seen[next])
+                        {
+                            seen[next] = true;
+                            set.push_back(next);
+                        }
+                    }
+                }
+                std::sort(set.begin(), set.end());
+            }
+        };
+
+        // Plain-word keywords an identifier pattern also matches; Lexer looks these up by
+        // identifier lexeme instead of scanning them.
+        static std::vector<bool> classifiedKeywords(const std::vector<Terminal> &terminals)
+        {
+            std::vector<std::regex> identifiers;
+            for (const auto &terminal : terminals)
+            {
+                if (terminal.getTerminalType() == TerminalType::IDENTIFIER)
+                    identifiers.emplace_back(std::string(terminal.getPattern()));
+            }
+
+            std::vector<bool> classified;
+            for (const auto &terminal : terminals)
+            {
+                auto text = std::string(terminal.getPattern());
+                classified.push_back(KeywordTable::isLiteral(terminal) &&
+                                     std::any_of(identifiers.begin(), identifiers.end(), [&](const std::regex &re) { return std::regex_match(text, re); }));
+            }
+            return classified;
+        }
+
+        // Subset construction. A DFA state accepts the first terminal in order that matches
+        // there, or the keyword an identifier match spells; a lazy terminal stops at its
+        // first accepting state.
+        static Automaton determinize(const Terminals_Type &set)
+        {
+            Automaton automaton{{set.begin(), set.end()}, {}};
+            const auto &terminals = automaton.terminals;
+            auto keywords = classifiedKeywords(terminals);
+
+            NfaBuilder nfa;
+            std::vector<bool> lazy;
+            std::vector<std::uint32_t> start;
+            for (std::uint32_t i = 0; i < terminals.size(); ++i)
+            {
+                bool isLazy = false;
+                auto tree = PatternParser::parse(terminals[i].getPattern(), isLazy);
+                auto [first, last] = nfa.build(tree, i);
+                nfa.states[last].accepting = true;
+                lazy.push_back(isLazy);
+                start.push_back(first);
+            }
+
+            auto accepts = [&](std::vector<std::uint32_t> &states) -> std::int32_t
+            {
+                std::int32_t first = -1, keyword = -1;
+                std::vector<bool> finished(terminals.size());
+                for (auto state : states)
+                {
+                    if (!nfa.states[state].accepting)
+                        continue;
+                    auto owner = std::int32_t(nfa.states[state].owner);
+                    finished[owner] = lazy[owner];
+                    auto &best = keywords[owner] ? keyword : first;
+                    if (best < 0 || owner < best)
+                        best = owner;
+                }
+                std::erase_if(states, [&](auto state)
+                              { return finished[nfa.states[state].owner] && !nfa.states[state].accepting; });
+                if (first >= 0 && keyword >= 0 && terminals[first].getTerminalType() == TerminalType::IDENTIFIER)
+                    return keyword;
+                return first;
+            };
+
+            if (terminals.empty())
+                return automaton;
+
+            std::map<std::vector<std::uint32_t>, std::int32_t> ids;
+            std::vector<std::vector<std::uint32_t>> pending;
+            auto intern = [&](std::vector<std::uint32_t> states) -> std::int32_t
+            {
+                nfa.closure(states);
+                auto accepted = accepts(states);
+                auto [it, inserted] = ids.try_emplace(states, std::int32_t(automaton.states.size()));
+                if (inserted)
+                {
+                    automaton.states.push_back(DfaState{});
+                    automaton.states.back().next.fill(-1);
+                    automaton.states.back().accepts = accepted;
+                    pending.push_back(states);
+                }
+                return it->second;
+            };
+
+            intern(start);
+            for (std::size_t index = 0; index < pending.size(); ++index)
+            {
+                std::array<std::vector<std::uint32_t>, 256> targets;
+                for (auto state : pending[index])
+                {
+                    const auto &from = nfa.states[state];
+                    if (from.on.none())
+                        continue;
+                    for (std::size_t byte = 0; byte < 256; ++byte)
+                    {
+                        if (from.on.test(byte))
+                            targets[byte].push_back(from.target);
+                    }
+                }
+                bool halts = true;
+                for (std::size_t byte = 0; byte < 256; ++byte)
+                {
+                    if (!targets[byte].empty())
+                    {
+                        auto next = intern(std::move(targets[byte]));
+                        automaton.states[index].next[byte] = next;
+                        halts = false;
+                    }
+                }
+                automaton.states[index].halts = halts;
+            }
+            return automaton;
+        }
+
+        static std::size_t examined(const Automaton &automaton, std::string_view input)
+        {
+            if (automaton.states.empty())
+                return 0;
+            std::size_t state = 0;
+            for (std::size_t i = 0; i < input.length(); ++i)
+            {
+                if (automaton.states[state].halts)
+                    return i;
+                auto next = automaton.states[state].next[(unsigned char)input[i]];
+                if (next < 0)
+                    return i + 1;
+                state = std::size_t(next);
+            }
+            return automaton.states[state].halts ? input.length() : input.length() + 1;
+        }
+
+        static std::string byteLiteral(unsigned byte)
+        {
+            if (byte >= 0x20 && byte < 0x7F && byte != '\'' && byte != '\\')
+                return std::string{'\'', char(byte), '\''};
+            constexpr std::string_view digits = "0123456789ABCDEF";
+            return std::string{"0x"} + digits[byte >> 4] + digits[byte & 0xF];
+        }
+
+        static std::string stringLiteral(std::string_view text)
+        {
+            std::string literal = "\"";
+            for (unsigned char c : text)
+            {
+                if (c == '"' || c == '\\')
+                    literal += {'\\', char(c)};
+                else if (c < 0x20 || c >= 0x7F)
+                    literal += {'\\', char('0' + (c >> 6)), char('0' + ((c >> 3) & 7)), char('0' + (c & 7))};
+                else
+                    literal += char(c);
+            }
+            return literal + "\"";
+        }
+
+        // Matcher function `name` for `automaton`, returning the terminal index and length.
+        static void emitMatcher(std::ostream &out, const Automaton &automaton, std::string_view name)
+        {
+            out << "        inline Match " << name << "(const char *begin, const char *end) noexcept\n"
+                << "        {\n";
+            if (automaton.states.empty())
+            {
+                out << "            (void)begin;\n"
+                    << "            (void)end;\n"
+                    << "            return {-1, 0};\n"
+                    << "        }\n";
+                return;
+            }
+
+            std::vector<bool> targeted(automaton.states.size());
+            for (const auto &state : automaton.states)
+            {
+                for (auto next : state.next)
+                {
+                    if (next >= 0)
+                        targeted[next] = true;
+                }
+            }
+
+            out << "            const char *p = begin;\n"
+                << "            const char *marker = begin;\n"
+                << "            std::int32_t accepted = -1;\n"
+                << "            unsigned char c;\n";
+            for (std::size_t index = 0; index < automaton.states.size(); ++index)
+            {
+                const auto &state = automaton.states[index];
+                if (targeted[index])
+                    out << "        s" << index << ":\n";
+                if (state.accepts >= 0)
+                {
+                    out << "            accepted = " << state.accepts << "; // "
+                        << stringLiteral(automaton.terminals[state.accepts].getName()) << "\n"
+                        << "            marker = p;\n";
+                }
+                if (std::all_of(state.next.begin(), state.next.end(), [](auto next) { return next < 0; }))
+                {
+                    out << "            goto done;\n";
+                    continue;
+                }
+
+                // Runs of bytes with the same target: short ones become case labels, long
+                // ones range tests.
+                std::vector<std::tuple<unsigned, unsigned, std::int32_t>> ranges;
+                for (unsigned byte = 0; byte < 256; ++byte)
+                {
+                    auto next = state.next[byte];
+                    if (next < 0)
+                        continue;
+                    if (!ranges.empty() && std::get<1>(ranges.back()) + 1 == byte && std::get<2>(ranges.back()) == next)
+                        std::get<1>(ranges.back()) = byte;
+                    else
+                        ranges.emplace_back(byte, byte, next);
+                }
+
+                out << "            if (p == end)\n"
+                    << "                goto done;\n"
+                    << "            c = (unsigned char)*p++;\n";
+                bool cases = std::any_of(ranges.begin(), ranges.end(), [](const auto &r) { return std::get<1>(r) - std::get<0>(r) < MAX_CASE_RUN; });
+                if (cases)
+                {
+                    out << "            switch (c)\n"
+                        << "            {\n";
+                    for (auto [low, high, next] : ranges)
+                    {
+                        if (high - low >= MAX_CASE_RUN)
+                            continue;
+                        for (auto byte = low; byte <= high; ++byte)
+                            out << "            case " << byteLiteral(byte) << ":\n";
+                        out << "                goto s" << next << ";\n";
+                    }
+                    out << "            default:\n"
+                        << "                break;\n"
+                        << "            }\n";
+                }
+                for (auto [low, high, next] : ranges)
+                {
+                    if (high - low < MAX_CASE_RUN)
+                        continue;
+                    if (low == 0 && high == 255)
+                        out << "            goto s" << next << ";\n";
+                    else if (low == 0 || high == 255)
+                        out << "            if (c " << (low == 0 ? "<= " + byteLiteral(high) : ">= " + byteLiteral(low)) << ")\n"
+                            << "                goto s" << next << ";\n";
+                    else
+                        out << "            if (c >= " << byteLiteral(low) << " && c <= " << byteLiteral(high) << ")\n"
+                            << "                goto s" << next << ";\n";
+                }
+                out << "            goto done;\n";
+            }
+            out << "        done:\n"
+                << "            return {accepted, std::size_t(marker - begin)};\n"
+                << "        }\n";
+        }
+
+        static void emitNames(std::ostream &out, const Automaton &automaton, std::string_view name)
+        {
+            out << "    inline constexpr std::array<std::string_view, " << automaton.terminals.size() << "> " << name << "{";
+            for (std::size_t i = 0; i < automaton.terminals.size(); ++i)
+                out << (i ? ", " : "") << stringLiteral(automaton.terminals[i].getName());
+            out << "};\n";
+        }
+
+    public:
+        static constexpr unsigned MAX_CASE_RUN = 4;
+
+        ScannerGenerator(const Terminals_Type &terminals, const Terminals_Type &skipTerminals)
+            : scanning{determinize(terminals)}, skipping{determinize(skipTerminals)}
+        {
+        }
+
+        explicit ScannerGenerator(const Grammar &grammar)
+            : ScannerGenerator(grammar.getTerminals(), grammar.getSkipTerminals())
+        {
+        }
+
+        std::size_t getStateCount() const noexcept { return scanning.states.size() + skipping.states.size(); }
+
+        // Bytes of `input` the scanner reads to find the lexeme at its start, the byte that
+        // ended the last candidate match included; input.length() + 1 if a match could still
+        // go on past the end.
+        std::size_t examined(std::string_view input) const
+        {
+            return std::max(examined(scanning, input), examined(skipping, input));
+        }
+
+        // Writes a self-contained header declaring, in namespace `ns`, the terminal names in
+        // Lexer::getTerminals() and getSkipSymbols() order and `Match scan(std::string_view)`.
+        void emit(std::ostream &out, std::string_view ns) const
+        {
+            out << "// Generated by ScannerGenerator; do not edit.\n"
+                << "#pragma once\n\n"
+                << "#include <array>\n"
+                << "#include <cstddef>\n"
+                << "#include <cstdint>\n"
+                << "#include <string_view>\n\n"
+                << "namespace " << ns << "\n"
+                << "{\n"
+                << "    // Lexeme at the start of the input: the index of its terminal in `terminals`,\n"
+                << "    // or in `skipTerminals` when `skip` is set; terminal -1 if nothing matches.\n"
+                << "    struct Match\n"
+                << "    {\n"
+                << "        std::int32_t terminal = -1;\n"
+                << "        std::size_t length = 0;\n"
+                << "        bool skip = false;\n"
+                << "    };\n\n";
+            emitNames(out, scanning, "terminals");
+            emitNames(out, skipping, "skipTerminals");
+            out << "\n"
+                << "    namespace detail\n"
+                << "    {\n";
+            emitMatcher(out, scanning, "matchTerminal");
+            out << "\n";
+            emitMatcher(out, skipping, "matchSkip");
+            out << "    } // namespace detail\n\n"
+                << "    inline Match scan(std::string_view input) noexcept\n"
+                << "    {\n"
+                << "        auto match = detail::matchTerminal(input.data(), input.data() + input.size());\n"
+                << "        if (match.length != 0)\n"
+                << "            return match;\n"
+                << "        match = detail::matchSkip(input.data(), input.data() + input.size());\n"
+                << "        if (match.length == 0)\n"
+                << "            return {};\n"
+                << "        match.skip = true;\n"
+                << "        return match;\n"
+                << "    }\n\n"
+                << "} // namespace " << ns << "\n";
+        }
+    };
+
+} // namespace IStudio::Compiler
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "Types_Compiler.hpp"
+#include "ParseTable.hpp"
+#include "Rule.hpp"
+#include "Terminal.hpp"
+#include "token.hpp"
+
+namespace IStudio::Compiler
+{
+    // Per-rule reduce callbacks evaluated during the parse (S-attributed). Each callback
+    // receives the values of the rule's right-hand side and returns the value of its left.
+    // Without a callback, a reduction yields its first child's value (or Value{} if empty).
+    template <typename Value>
+    class SemanticActions
+    {
+    public:
+        using TokenAction = std::function<Value(const Token &)>;
+        using ReduceAction = std::function<Value(std::span<Value>)>;
+
+    private:
+        TokenAction defaultTokenAction = [](const Token &) { return Value{}; };
+        std::vector<std::pair<Terminal, TokenAction>> tokenActions;
+        std::vector<std::pair<Rule, ReduceAction>> reduceActions;
+
+    public:
+        SemanticActions &onToken(TokenAction action)
+        {
+            defaultTokenAction = std::move(action);
+            return *this;
+        }
+
+        SemanticActions &onToken(const Terminal &terminal, TokenAction action)
+        {
+            tokenActions.emplace_back(terminal, std::move(action));
+            return *this;
+        }
+
+        SemanticActions &onReduce(const Rule &rule, ReduceAction action)
+        {
+            reduceActions.emplace_back(rule, std::move(action));
+            return *this;
+        }
+
+        const TokenAction &getTokenAction() const noexcept { return defaultTokenAction; }
+        const auto &getTokenActions() const noexcept { return tokenActions; }
+        const auto &getReduceActions() const noexcept { return reduceActions; }
+    };
+
+    // ParseDriver builder dispatching to SemanticActions through tables indexed by symbol and rule id.
+    template <typename Value>
+    class SemanticActionBuilder
+    {
+    private:
+        using Actions = SemanticActions<Value>;
+
+        const typename Actions::TokenAction &defaultTokenAction;
+        const ParseTable &table;
+        std::vector<const typename Actions::TokenAction *> tokenActions;
+        std::vector<const typename Actions::ReduceAction *> reduceActions;
+
+    public:
+        using value_type = Value;
+
+        SemanticActionBuilder(const Actions &actions, const ParseTable &table)
+            : defaultTokenAction(actions.getTokenAction()), table(table),
+              tokenActions(table.getTerminalCount(), nullptr), reduceActions(table.getRuleCount(), nullptr)
+        {
+            for (const auto &[terminal, action] : actions.getTokenActions())
+            {
+                if (auto id = table.getSymbolId(terminal); id && table.isTerminal(*id))
+                    tokenActions[*id] = &action;
+            }
+
+            for (const auto &[rule, action] : actions.getReduceActions())
+            {
+                for (ParseTable::RuleId id = 0; id < table.getRuleCount(); ++id)
+                {
+                    if (table.getRule(id).rule == rule)
+                        reduceActions[id] = &action;
+                }
+            }
+        }
+
+        value_type shift(const Token &token, [[maybe_unused]] std::size_t index)
+        {
+            auto id = table.getSymbolId(token.getTerminal());
+            if (id && *id < tokenActions.size() && tokenActions[*id])
+                return (*tokenActions[*id])(token);
+            return defaultTokenAction(token);
+        }
+
+        value_type reduce(const ParseTable::RuleInfo &rule, std::span<value_type> children)
+        {
+            if (const auto *action = reduceActions[rule.id])
+                return (*action)(children);
+            return children.empty() ? Value{} : std::move(children.front());
+        }
+    };
+
+} // namespace IStudio::Compiler
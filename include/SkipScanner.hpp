@@ -0,0 +1,277 @@
+#pragma once
+
+#include "Types_Compiler.hpp"
+#include "Terminal.hpp"
+#include "FirstBytes.hpp"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace IStudio::Compiler
+{
+    // Direct matcher for the skip-terminal shapes common in grammars: a byte class with
+    // an optional `+`/`*` (`\s`, `[ \t]+`), alternatives of plain strings (`\r\n|\r|\n`),
+    // and comments tagged CommentType::LINE (`//[^\n]*`) or BLOCK (`/\*[\s\S]*?\*/`).
+    // match() gives the same length as the regex would; patterns of any other shape are
+    // reported as Kind::NONE and stay with the regex.
+    class SkipScanner
+    {
+    public:
+        enum class Kind
+        {
+            NONE,
+            CLASS,
+            LITERALS,
+            LINE_COMMENT,
+            BLOCK_COMMENT
+        };
+
+    private:
+        Kind kind = Kind::NONE;
+        ByteSet bytes;              // CLASS
+        bool repeat = false;        // CLASS: `+` or `*`
+        std::string members;        // CLASS: the bytes of small sets, for the SSE2 loop
+        std::vector<std::string> literals; // LITERALS
+        std::string open, close;    // comments; `close` is the line end set for LINE_COMMENT
+
+        static constexpr std::size_t MAX_SIMD_MEMBERS = 8;
+
+        // Text of a pattern made only of plain characters and escaped punctuation.
+        static std::optional<std::string> literalText(std::string_view pattern)
+        {
+            std::string text;
+            for (std::size_t i = 0; i < pattern.length(); ++i)
+            {
+                char c = pattern[i];
+                if (c == '\\' && i + 1 < pattern.length())
+                {
+                    char e = pattern[++i];
+                    switch (e)
+                    {
+                    case 'n': text += '\n'; break;
+                    case 'r': text += '\r'; break;
+                    case 't': text += '\t'; break;
+                    case 'f': text += '\f'; break;
+                    case 'v': text += '\v'; break;
+                    default:
+                        if (std::isalnum((unsigned char)e))
+                            return std::nullopt;
+                        text += e;
+                    }
+                }
+                else if (std::string_view{"^$.|?*+()[]{}\\"}.find(c) != std::string_view::npos)
+                    return std::nullopt;
+                else
+                    text += c;
+            }
+            return text;
+        }
+
+        // Length of the single-byte atom at the start of `pattern`, or 0.
+        static std::size_t atomLength(std::string_view pattern)
+        {
+            if (pattern.empty())
+                return 0;
+            if (pattern.front() == '[')
+            {
+                for (std::size_t i = 1; i < pattern.length(); ++i)
+                {
+                    if (pattern[i] == '\\')
+                        ++i;
+                    else if (pattern[i] == ']' && i > 1)
+                        return i + 1;
+                }
+                return 0;
+            }
+            if (pattern.front() == '\\')
+                return pattern.length() >= 4 && pattern[1] == 'x' ? 4 : std::min<std::size_t>(pattern.length(), 2);
+            if (std::string_view{"^$|?*+()]{}"}.find(pattern.front()) != std::string_view::npos)
+                return 0;
+            return 1;
+        }
+
+        bool classShape(std::string_view pattern)
+        {
+            auto length = atomLength(pattern);
+            if (length == 0)
+                return false;
+            auto quantifier = pattern.substr(length);
+            if (!quantifier.empty() && quantifier != "+" && quantifier != "*")
+                return false;
+
+            bytes = FirstBytes::of(pattern.substr(0, length));
+            if (bytes.none() || bytes.all())
+                return false; // not understood, or `[]`
+            repeat = !quantifier.empty();
+            if (bytes.count() <= MAX_SIMD_MEMBERS)
+            {
+                for (std::size_t b = 0; b < 256; ++b)
+                {
+                    if (bytes.test(b))
+                        members += char(b);
+                }
+            }
+            return true;
+        }
+
+        bool literalsShape(std::string_view pattern)
+        {
+            std::size_t begin = 0;
+            while (true)
+            {
+                auto bar = pattern.find('|', begin);
+                auto text = literalText(pattern.substr(begin, bar == std::string_view::npos ? bar : bar - begin));
+                if (!text)
+                    return false;
+                if (text->empty())
+                    break; // the regex takes the empty match, later alternatives never apply
+                literals.push_back(std::move(*text));
+                if (bar == std::string_view::npos)
+                    break;
+                begin = bar + 1;
+            }
+            return !literals.empty();
+        }
+
+        bool lineCommentShape(std::string_view pattern)
+        {
+            for (auto [body, stops] : {std::pair{"[^\\n]*", "\n"}, std::pair{"[^\\r\\n]*", "\r\n"}, std::pair{".*", "\r\n"}})
+            {
+                if (!pattern.ends_with(body))
+                    continue;
+                auto prefix = literalText(pattern.substr(0, pattern.length() - std::string_view{body}.length()));
+                if (!prefix || prefix->empty())
+                    return false;
+                open = std::move(*prefix);
+                close = stops;
+                return true;
+            }
+            return false;
+        }
+
+        bool blockCommentShape(std::string_view pattern)
+        {
+            for (std::string_view body : {"[\\s\\S]*?", "[\\S\\s]*?", "[^]*?"})
+            {
+                auto at = pattern.find(body);
+                if (at == std::string_view::npos)
+                    continue;
+                auto opening = literalText(pattern.substr(0, at));
+                auto closing = literalText(pattern.substr(at + body.length()));
+                if (!opening || !closing || opening->empty() || closing->empty())
+                    return false;
+                open = std::move(*opening);
+                close = std::move(*closing);
+                return true;
+            }
+            return false;
+        }
+
+        // Number of leading bytes of `input` in `bytes`.
+        std::size_t span(std::string_view input) const
+        {
+            std::size_t i = 0;
+#if defined(__SSE2__)
+            if (!members.empty())
+            {
+                for (; i + 16 <= input.length(); i += 16)
+                {
+                    auto block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input.data() + i));
+                    auto hits = _mm_setzero_si128();
+                    for (char member : members)
+                        hits = _mm_or_si128(hits, _mm_cmpeq_epi8(block, _mm_set1_epi8(member)));
+                    auto mask = unsigned(_mm_movemask_epi8(hits));
+                    if (mask != 0xFFFF)
+                        return i + std::size_t(std::countr_one(mask));
+                }
+            }
+#endif
+            while (i < input.length() && bytes.test((unsigned char)input[i]))
+                ++i;
+            return i;
+        }
+
+    public:
+        SkipScanner() = default;
+
+        explicit SkipScanner(const Terminal &terminal)
+        {
+            auto pattern = terminal.getPattern();
+            if (terminal.getCommentType() == CommentType::LINE && lineCommentShape(pattern))
+                kind = Kind::LINE_COMMENT;
+            else if (terminal.getCommentType() == CommentType::BLOCK && blockCommentShape(pattern))
+                kind = Kind::BLOCK_COMMENT;
+            else if (classShape(pattern))
+                kind = Kind::CLASS;
+            else if (literalsShape(pattern))
+                kind = Kind::LITERALS;
+        }
+
+        Kind getKind() const noexcept { return kind; }
+
+        // Whether text after `input` could still change match(): a comment whose end is not
+        // in sight, or a run or literal cut off by the end of `input`.
+        bool needsMore(std::string_view input) const
+        {
+            switch (kind)
+            {
+            case Kind::CLASS:
+                return repeat && !input.empty() && span(input) == input.length();
+            case Kind::LITERALS:
+                for (const auto &literal : literals)
+                {
+                    if (input.starts_with(literal))
+                        return false; // later alternatives cannot take over
+                    if (literal.starts_with(input))
+                        return true;
+                }
+                return false;
+            case Kind::LINE_COMMENT:
+            case Kind::BLOCK_COMMENT:
+                if (input.length() < open.length())
+                    return open.starts_with(input);
+                return input.starts_with(open) && match(input) == (kind == Kind::LINE_COMMENT ? input.length() : 0);
+            default:
+                return false;
+            }
+        }
+
+        // Length of the match at the start of `input`; 0 if there is none. Like the regex,
+        // alternatives of plain strings take the first one that matches, not the longest.
+        std::size_t match(std::string_view input) const
+        {
+            switch (kind)
+            {
+            case Kind::CLASS:
+                if (input.empty() || !bytes.test((unsigned char)input.front()))
+                    return 0;
+                return repeat ? span(input) : 1;
+            case Kind::LITERALS:
+                for (const auto &literal : literals)
+                {
+                    if (input.starts_with(literal))
+                        return literal.length();
+                }
+                return 0;
+            case Kind::LINE_COMMENT:
+            {
+                if (!input.starts_with(open))
+                    return 0;
+                auto end = close.length() == 1 ? input.find(close.front(), open.length()) : input.find_first_of(close, open.length());
+                return end == std::string_view::npos ? input.length() : end;
+            }
+            case Kind::BLOCK_COMMENT:
+            {
+                if (!input.starts_with(open))
+                    return 0;
+                auto end = input.find(close, open.length());
+                return end == std::string_view::npos ? 0 : end + close.length();
+            }
+            default:
+                return 0;
+            }
+        }
+    };
+
+} // namespace IStudio::Compiler
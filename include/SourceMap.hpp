@@ -0,0 +1,110 @@
+#pragma once
+
+#include "Types_Compiler.hpp"
+#include "Lang.hpp"
+#include "Error.hpp"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace IStudio::Compiler
+{
+    // Line starts of a source buffer, found in one pass, so that tokens and diagnostics
+    // carry only a byte offset and get their line and column by binary search when shown.
+    // A line ends at "\n", "\r\n" or a lone "\r", like the usual `\r\n|\r|\n` newline
+    // terminal; columns count bytes from 1.
+    class SourceMap
+    {
+    public:
+        struct Location
+        {
+            Lang::Integer line = 1;
+            Lang::Integer column = 1;
+        };
+
+    private:
+        std::vector<std::size_t> lineStarts{0};
+        std::size_t dropped = 0;    // lines before lineStarts.front(), see trim()
+        std::size_t length = 0;     // bytes appended so far
+        bool pendingReturn = false; // the text so far ends in '\r'
+
+    public:
+        SourceMap() = default;
+
+        explicit SourceMap(std::string_view text)
+        {
+            append(text);
+        }
+
+        // Extends the map with the next `text` of the source, for input read in pieces; a
+        // "\r\n" split between two pieces is still one line end.
+        void append(std::string_view text)
+        {
+            auto lineEnd = [&](std::size_t i)
+            {
+                std::size_t next = length + i + 1;
+                if (text[i] == '\n' && (i > 0 ? text[i - 1] == '\r' : pendingReturn))
+                    lineStarts.back() = next;
+                else
+                    lineStarts.push_back(next);
+            };
+
+            std::size_t i = 0;
+#if defined(__SSE2__)
+            const auto cr = _mm_set1_epi8('\r');
+            const auto lf = _mm_set1_epi8('\n');
+            for (; i + 16 <= text.length(); i += 16)
+            {
+                auto block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text.data() + i));
+                auto mask = unsigned(_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(block, cr), _mm_cmpeq_epi8(block, lf))));
+                for (; mask != 0; mask &= mask - 1)
+                    lineEnd(i + std::size_t(std::countr_zero(mask)));
+            }
+#endif
+            for (; i < text.length(); ++i)
+            {
+                if (text[i] == '\n' || text[i] == '\r')
+                    lineEnd(i);
+            }
+            if (!text.empty())
+                pendingReturn = text.back() == '\r';
+            length += text.length();
+        }
+
+        // Forgets the lines before the one holding `offset`, so a map kept over a stream
+        // stays small; offsets before that line can no longer be located.
+        void trim(std::size_t offset)
+        {
+            auto keep = std::upper_bound(lineStarts.begin(), lineStarts.end(), offset);
+            if (keep != lineStarts.begin())
+                --keep;
+            dropped += std::size_t(keep - lineStarts.begin());
+            lineStarts.erase(lineStarts.begin(), keep);
+        }
+
+        Location locate(std::size_t offset) const
+        {
+            auto line = std::upper_bound(lineStarts.begin(), lineStarts.end(), offset);
+            if (line != lineStarts.begin())
+                --line;
+            return {Lang::Integer(dropped + std::size_t(line - lineStarts.begin()) + 1),
+                    Lang::Integer(offset - std::min(offset, *line) + 1)};
+        }
+
+        // Fills in the line and column of every diagnostic from its offset.
+        void locate(Error::Diagnostics &diagnostics) const
+        {
+            for (auto &diagnostic : diagnostics)
+            {
+                auto [line, column] = locate(diagnostic.offset);
+                diagnostic.line = line;
+                diagnostic.column = column;
+            }
+        }
+
+        std::size_t lineCount() const noexcept { return dropped + lineStarts.size(); }
+        std::size_t size() const noexcept { return length; }
+    };
+
+} // namespace IStudio::Compiler
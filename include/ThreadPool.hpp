@@ -0,0 +1,115 @@
+#pragma once
+
+#include "Types_Compiler.hpp"
+
+namespace IStudio::Util
+{
+    // Fixed set of worker threads fed from one task queue.
+    class ThreadPool
+    {
+    private:
+        std::mutex mutex;
+        std::condition_variable available;
+        std::deque<std::function<void()>> tasks;
+        bool stopping = false;
+        std::vector<std::jthread> workers; // last, so it is joined before the rest is destroyed
+
+        void work()
+        {
+            while (true)
+            {
+                std::function<void()> task;
+                {
+                    std::unique_lock lock{mutex};
+                    available.wait(lock, [this] { return stopping || !tasks.empty(); });
+                    if (tasks.empty())
+                        return;
+                    task = std::move(tasks.front());
+                    tasks.pop_front();
+                }
+                task();
+            }
+        }
+
+    public:
+        explicit ThreadPool(std::size_t threads = std::max(1u, std::thread::hardware_concurrency()))
+        {
+            workers.reserve(threads);
+            for (std::size_t i = 0; i < std::max<std::size_t>(threads, 1); ++i)
+                workers.emplace_back([this] { work(); });
+        }
+
+        ThreadPool(const ThreadPool &) = delete;
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+        // Finishes the queued tasks, then joins the workers.
+        ~ThreadPool()
+        {
+            {
+                std::lock_guard lock{mutex};
+                stopping = true;
+            }
+            available.notify_all();
+        }
+
+        std::size_t size() const noexcept { return workers.size(); }
+
+        void submit(std::function<void()> task)
+        {
+            {
+                std::lock_guard lock{mutex};
+                tasks.push_back(std::move(task));
+            }
+            available.notify_one();
+        }
+
+        // Calls fn(index, slot) for every index in [0, count) and waits for all of them.
+        // Indices are handed out one at a time, so uneven items balance across workers;
+        // `slot` is below size() and unique among concurrent calls, for per-worker scratch
+        // state. The first exception thrown is rethrown here. Must not be called from a task
+        // of the same pool.
+        void parallelFor(std::size_t count, const std::function<void(std::size_t, std::size_t)> &fn)
+        {
+            if (count == 0)
+                return;
+
+            std::atomic<std::size_t> next{0};
+            std::exception_ptr failure;
+            std::mutex failureMutex;
+            auto slots = std::min(size(), count);
+            std::latch done{std::ptrdiff_t(slots)};
+
+            for (std::size_t slot = 0; slot < slots; ++slot)
+            {
+                submit([&, slot]
+                       {
+                           try
+                           {
+                               for (auto index = next++; index < count; index = next++)
+                                   fn(index, slot);
+                           }
+                           catch (...)
+                           {
+                               std::lock_guard lock{failureMutex};
+                               if (!failure)
+                                   failure = std::current_exception();
+                               next = count;
+                           }
+                           done.count_down();
+                       });
+            }
+
+            done.wait();
+            if (failure)
+                std::rethrow_exception(failure);
+        }
+
+        // Process-wide pool with one worker per hardware thread.
+        static ThreadPool &shared()
+        {
+            static ThreadPool pool;
+            return pool;
+        }
+    };
+
+} // namespace IStudio::Util
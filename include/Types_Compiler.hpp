@@ -2,31 +2,48 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <bit>
+#include <bitset>
 #include <cassert>
+#include <cctype>
+#include <charconv>
+#include <condition_variable>
 #include <coroutine>
 #include <cstdint>
+#include <cstring>
 #include <ctime>
+#include <deque>
 #include <expected>
 #include <filesystem>
 #include <format>
 #include <fstream>
 #include <functional>
+#include <iomanip>
 #include <iostream>
 #include <iterator>
+#include <latch>
+#include <limits>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <numeric>
 #include <optional>
 #include <queue>
 #include <ranges>
 #include <regex>
 #include <set>
+#include <shared_mutex>
 #include <source_location>
+#include <span>
 #include <sstream>
 #include <stacktrace>
 #include <stdexcept>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
+#include <variant>
 #include <vector>
 namespace fs = std::filesystem;
 // #include <generator>
\ No newline at end of file
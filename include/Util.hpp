@@ -50,6 +50,7 @@ namespace IStudio::Util
         struct promise_type
         {
             T current_value;
+            std::exception_ptr exception;
 
             auto initial_suspend() noexcept
             {
@@ -69,9 +70,10 @@ namespace IStudio::Util
 
             void return_void() noexcept {}
 
+            // Rethrown to the consumer from begin() / operator++.
             void unhandled_exception()
             {
-                std::terminate();
+                exception = std::current_exception();
             }
 
             auto get_return_object() noexcept
@@ -122,6 +124,7 @@ namespace IStudio::Util
             void operator++()
             {
                 coro_handle.resume();
+                settle();
             }
 
             const T &operator*() const
@@ -137,6 +140,18 @@ namespace IStudio::Util
         private:
             iterator(handle_type h) : coro_handle(h) {}
 
+            // A finished coroutine compares equal to end().
+            void settle()
+            {
+                if (coro_handle && coro_handle.done())
+                {
+                    auto exception = coro_handle.promise().exception;
+                    coro_handle = nullptr;
+                    if (exception)
+                        std::rethrow_exception(exception);
+                }
+            }
+
             friend class generator;
             handle_type coro_handle;
         };
@@ -145,7 +160,9 @@ namespace IStudio::Util
         {
             if (coro_handle)
                 coro_handle.resume();
-            return iterator{coro_handle};
+            iterator it{coro_handle};
+            it.settle();
+            return it;
         }
 
         iterator end() const
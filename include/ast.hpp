@@ -1,6 +1,8 @@
 #ifndef __AST_HPP__
 #define __AST_HPP__
 #include "Types_Compiler.hpp"
+#include "ParseTable.hpp"
+#include "token.hpp"
 
 namespace IStudio::Compiler
 {
@@ -9,9 +11,14 @@ namespace IStudio::Compiler
     public:
         Symbol symbol;
         std::vector<std::shared_ptr<ASTNode>> children;
+        std::uint32_t tokenCount = 0; // tokens covered by the subtree
+        Atom atom = NO_ATOM;          // leaves: the token's interned lexeme
+        ParseTable::StateId state = ParseTable::NO_STATE; // state below the node on the parse stack
 
         ASTNode(Symbol s) : symbol(std::move(s)) {}
 
+        ASTNode(Symbol s, std::vector<std::shared_ptr<ASTNode>> c) : symbol(std::move(s)), children(std::move(c)) {}
+
         void addChild(const std::shared_ptr<ASTNode> &child)
         {
             children.push_back(child);
@@ -23,6 +30,39 @@ namespace IStudio::Compiler
             return os;
         }
     };
+    // ParseDriver builder producing the shared_ptr based ASTNode tree.
+    class ASTBuilder
+    {
+    public:
+        using value_type = std::shared_ptr<ASTNode>;
+
+        value_type shift(const Token &token, [[maybe_unused]] std::size_t index)
+        {
+            auto node = std::make_shared<ASTNode>(token.getTerminal());
+            node->tokenCount = 1;
+            node->atom = token.getAtom();
+            return node;
+        }
+
+        value_type reduce(const ParseTable::RuleInfo &rule, std::span<value_type> children)
+        {
+            std::uint32_t tokens = 0;
+            for (const auto &child : children)
+                tokens += child->tokenCount;
+
+            auto node = std::make_shared<ASTNode>(rule.rule.getLeft(),
+                                                  std::vector<value_type>{std::make_move_iterator(children.begin()),
+                                                                          std::make_move_iterator(children.end())});
+            node->tokenCount = tokens;
+            return node;
+        }
+
+        void pushed(const value_type &node, ParseTable::StateId state)
+        {
+            node->state = state;
+        }
+    };
+
     class ASTPrinter
     {
     public:
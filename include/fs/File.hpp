@@ -4,10 +4,51 @@
 #include "Types_Compiler.hpp"
 #include "Exception.hpp"
 
+#if __has_include(<sys/mman.h>)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define FS_FILE_HAS_MMAP 1
+#endif
+
 class File
 {
 private:
     std::fstream fileStream;
+    fs::path path;
+    const char *mapping = nullptr;
+    std::size_t mappingSize = 0;
+    std::string buffer; // contents when the file could not be mapped
+    bool loaded = false;
+
+    void load()
+    {
+#if defined(FS_FILE_HAS_MMAP)
+        struct stat info;
+        if (::stat(path.c_str(), &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0)
+        {
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd >= 0)
+            {
+                auto size = std::size_t(info.st_size);
+                void *address = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+                ::close(fd);
+                if (address != MAP_FAILED)
+                {
+                    ::madvise(address, size, MADV_SEQUENTIAL);
+                    ::madvise(address, size, MADV_WILLNEED);
+                    mapping = static_cast<const char *>(address);
+                    mappingSize = size;
+                }
+            }
+        }
+#endif
+        // Pipes, devices and files the kernel reports as empty are read from the stream.
+        if (!mapping)
+            buffer.assign(std::istreambuf_iterator<char>{fileStream}, std::istreambuf_iterator<char>{});
+        loaded = true;
+    }
 
 public:
     File() = default;
@@ -26,7 +67,9 @@ public:
     {
         if (fs::exists(filePath))
         {
-            fileStream.open(filePath);
+            close();
+            path = filePath;
+            fileStream.open(filePath, std::ios::in | std::ios::binary);
             return fileStream.is_open();
         }
         else
@@ -41,7 +84,31 @@ public:
         {
             fileStream.close();
         }
+#if defined(FS_FILE_HAS_MMAP)
+        if (mapping)
+            ::munmap(const_cast<char *>(mapping), mappingSize);
+#endif
+        mapping = nullptr;
+        mappingSize = 0;
+        buffer.clear();
+        loaded = false;
     }
+
+    // Read-only view of the whole file. Regular files are memory-mapped with sequential
+    // access hints, others (pipes) are read into a buffer. Valid until close(). Throws if
+    // the file is not open, e.g. because open() could not read it.
+    std::string_view view()
+    {
+        if (!loaded)
+        {
+            if (!fileStream.is_open())
+                throw IStudio::Exception::RuntimeException{std::string{"File could not be opened for reading : "} + path.string()};
+            load();
+        }
+        return mapping ? std::string_view{mapping, mappingSize} : std::string_view{buffer};
+    }
+
+    bool isMapped() const noexcept { return mapping != nullptr; }
 };
 
 #endif // FS_FILE_HPP_
\ No newline at end of file
@@ -4,20 +4,26 @@
 #include "Lang.hpp"
 #include "Terminal.hpp"
 #include "UUID.h"
+#include "AtomTable.hpp"
+#include "Literal.hpp"
 
 namespace IStudio::Compiler
 {
 
     class Token
     {
+    public:
+        static constexpr std::uint32_t NO_REACH_LIMIT = std::numeric_limits<std::uint32_t>::max();
+
     private:
         Util::UUID uuid;
 
         Terminal terminal;
         Lang::String code;
-
-        Lang::Integer column;
-        Lang::Integer line;
+        std::size_t offset = 0; // byte offset of the lexeme in the source; see SourceMap
+        Atom atom = NO_ATOM;    // interned lexeme, see Lexer::setAtomTable
+        std::uint32_t reach = 0; // see getReach
+        LiteralValue value;     // decoded literal, see Literal
 
 
     public:
@@ -26,14 +32,37 @@ namespace IStudio::Compiler
             return uuid;
         }
 
-        auto &getColumn() const
+        auto &getOffset() const
+        {
+            return offset;
+        }
+
+        Atom getAtom() const noexcept
         {
-            return column;
+            return atom;
         }
 
-        auto &getLine() const
+        // How far past the offset lexing the token, and the skips before it, read the text,
+        // or 0 where not recorded; see Lexer::relex. NO_REACH_LIMIT stands for any length.
+        std::uint32_t getReach() const noexcept
         {
-            return line;
+            return reach;
+        }
+
+        void setReach(std::size_t bytes) noexcept
+        {
+            reach = std::uint32_t(std::min<std::size_t>(bytes, NO_REACH_LIMIT));
+        }
+
+        // End of the text a token at `offset` with `reach` examined.
+        static std::size_t reachEnd(std::size_t offset, std::uint32_t reach) noexcept
+        {
+            return reach == NO_REACH_LIMIT ? std::numeric_limits<std::size_t>::max() : offset + reach;
+        }
+
+        const LiteralValue &getValue() const noexcept
+        {
+            return value;
         }
 
         auto &getCode() const
@@ -46,29 +75,43 @@ namespace IStudio::Compiler
             return terminal;
         }
 
+        // Moves the token by `delta` bytes, for text inserted or removed before it.
+        void moveBy(std::ptrdiff_t delta) noexcept
+        {
+            offset = std::size_t(std::ptrdiff_t(offset) + delta);
+        }
+
         Token() = default;
 
-        Token(const Terminal& t, Lang::String c, Lang::Integer col, Lang::Integer l) : 
+        Token(const Terminal& t, Lang::String c, std::size_t o = 0, Atom a = NO_ATOM, LiteralValue v = {}) : 
                                                                                 terminal{t},
                                                                                 code{c},
-                                                                                column{col},
-                                                                                line{l}
+                                                                                offset{o},
+                                                                                atom{a},
+                                                                                value{std::move(v)}
         {
         }
 
         Token(const Token &t) : uuid{t.getId()},
                                 terminal{t.getTerminal()},
                                 code{t.getCode()},
-                                column{t.getColumn()},
-                                line{t.getLine()}
+                                offset{t.getOffset()},
+                                atom{t.getAtom()},
+                                reach{t.reach},
+                                value{t.getValue()}
         {
         }
 
+        Token(Token &&t) noexcept = default;
+        Token &operator=(Token &&t) noexcept = default;
+
         Token &operator=(const Token &t)
         {
             uuid = t.getId();
-            column = t.getColumn();
-            line = t.getLine();
+            offset = t.getOffset();
+            atom = t.getAtom();
+            reach = t.reach;
+            value = t.getValue();
             code = t.getCode();
             terminal = t.getTerminal();
 
@@ -88,7 +131,7 @@ namespace IStudio::Compiler
         }
 
         friend std::ostream& operator<<(std::ostream& o, const Token& t){
-            o << "{ column : " << t.getColumn() << " , line : " << t.getLine() << " , terminal : " << t.getTerminal() << " , code : " << t.getCode() << "}";
+            o << "{ offset : " << t.getOffset() << " , terminal : " << t.getTerminal() << " , code : " << t.getCode() << "}";
 
             return o;
         }
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <Grammar.hpp>
+#include <Nonterminal.hpp>
+#include <Terminal.hpp>
+#include <Logger.hpp>
+
+// The production language, shared by the compiler and the scanner generator.
+inline IStudio::Compiler::Grammar language(IStudio::Log::Logger &logger)
+{
+	using namespace IStudio::Compiler;
+	using namespace IStudio::Log;
+
+	// Define grammar elements
+	logger(LogLevel::DEBUG) << "Defining NonTerminals...";
+	Nonterminal start{"start"};
+	Nonterminal ImportStatement{"ImportStatement"};
+	Nonterminal package{"package"};
+	Nonterminal packages{"packages"};
+
+	logger(LogLevel::DEBUG) << "Defining Terminals...";
+	Terminal import{"import", "import", 10, Associativity::LEFT, TerminalType::KEYWORD};
+	Terminal from{"from", "from", 10, Associativity::LEFT, TerminalType::KEYWORD};
+	Terminal as{"as", "as", 10, Associativity::LEFT, TerminalType::KEYWORD};
+	Terminal semicolon{"semicolon", ";", 400, Associativity::LEFT, TerminalType::SEPARATOR};
+	Terminal space{"space", "\\s", 500, Associativity::LEFT, TerminalType::SPECIAL};
+	Terminal newline{"newline", "\r\n|\r|\n", 500, Associativity::LEFT, TerminalType::SPECIAL};
+	Terminal identifier{"identifier", "[a-zA-Z_][a-zA-Z0-9_]*", 1000, Associativity::LEFT, TerminalType::IDENTIFIER};
+
+	logger(LogLevel::DEBUG) << "Creating rules...";
+	Rule FirstRule = start <= rule(ImportStatement);
+
+	return Grammar{
+		start,
+		Grammar::Terminals_Type{import, from, as, identifier, semicolon},
+		Grammar::Terminals_Type{space, newline},
+		Grammar::NonTerminals_Type{start, ImportStatement, package, packages},
+		FirstRule,
+		Grammar::Rules_Type{
+			FirstRule,
+			ImportStatement <= rule(from, package, import, package, semicolon),
+			ImportStatement <= rule(from, package, import, packages, semicolon),
+			ImportStatement <= rule(from, package, import, package, as, identifier, semicolon),
+			ImportStatement <= rule(),
+			package <= rule(identifier)
+		},
+		logger
+	};
+}
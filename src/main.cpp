@@ -7,6 +7,7 @@
 #include <Compiler.hpp>
 #include <fs/File.hpp>
 #include <Logger.hpp>
+#include "Language.hpp"
 
 
 int main()
@@ -24,46 +25,8 @@ int main()
 	logger(LogLevel::INFO) << "Starting Compiler Program...";
 
 	try {
-		// Define grammar elements
-		logger(LogLevel::DEBUG) << "Defining NonTerminals...";
-		Nonterminal start{"start"};
-		Nonterminal ImportStatement{"ImportStatement"};
-		Nonterminal package{"package"};
-		Nonterminal packages{"packages"};
-
-	
-
-		logger(LogLevel::DEBUG) << "Defining Terminals...";
-		Terminal import{"import", "import", 10, Associativity::LEFT, TerminalType::KEYWORD};
-		Terminal from{"from", "from", 10, Associativity::LEFT, TerminalType::KEYWORD};
-		Terminal as{"as", "as", 10, Associativity::LEFT, TerminalType::KEYWORD};
-		Terminal semicolon{"semicolon", ";", 400, Associativity::LEFT, TerminalType::SEPARATOR};
-		Terminal space{"space", "\\s", 500, Associativity::LEFT, TerminalType::SPECIAL};
-		Terminal newline{"newline", "\r\n|\r|\n", 500, Associativity::LEFT, TerminalType::SPECIAL};
-		Terminal identifier{"identifier", "[a-zA-Z_][a-zA-Z0-9_]*", 1000, Associativity::LEFT, TerminalType::IDENTIFIER};
-
-
-		logger(LogLevel::DEBUG) << "Creating rules...";
-		Rule FirstRule = start <= rule(ImportStatement);
-
-
 		logger(LogLevel::INFO) << "Constructing grammar...";
-		Grammar grammar{
-			start,
-			Grammar::Terminals_Type{import, from, as, identifier, semicolon},
-			Grammar::Terminals_Type{space, newline},
-			Grammar::NonTerminals_Type{start, ImportStatement, package, packages},
-			FirstRule,
-			Grammar::Rules_Type{
-				FirstRule,
-				ImportStatement <= rule(from, package, import, package, semicolon),
-				ImportStatement <= rule(from, package, import, packages, semicolon),
-				ImportStatement <= rule(from, package, import, package, as, identifier, semicolon),
-				ImportStatement <= rule(),
-				package <= rule(identifier)
-			},
-			logger
-		};
+		Grammar grammar = language(logger);
 
 
 		logger(LogLevel::INFO) << "Grammar constructed successfully.";
@@ -0,0 +1,42 @@
+#include <iostream>
+#include <fstream>
+#include <ScannerGenerator.hpp>
+#include <Exception.hpp>
+#include <Logger.hpp>
+#include "Language.hpp"
+
+
+// Writes the direct-coded scanner of the language's terminals to the file named by the
+// first argument, or to standard output, in the namespace named by the second argument.
+int main(int argc, char **argv)
+{
+	using namespace IStudio::Compiler;
+	using namespace IStudio::Log;
+
+	Logger logger("scannergen.log", LogLevel::INFO);
+	logger.setDefaultLogLevel({LogLevel::INFO, LogLevel::ERROR});
+
+	std::string ns = argc > 2 ? argv[2] : "IStudio::Compiler::Generated";
+
+	try {
+		ScannerGenerator generator{language(logger)};
+		logger(LogLevel::INFO) << "Scanner states: " << generator.getStateCount();
+
+		if (argc > 1)
+		{
+			std::ofstream out{argv[1], std::ios::out | std::ios::trunc};
+			if (!out)
+				throw IStudio::Exception::FileNotFoundException{std::string("Cannot write ") + argv[1]};
+			generator.emit(out, ns);
+		}
+		else
+			generator.emit(std::cout, ns);
+	}
+	catch (const std::exception &e)
+	{
+		logger(LogLevel::CRITICAL) << "Scanner generation failed: " << e.what();
+		std::cerr << "Scanner generation failed: " << e.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}